@@ -0,0 +1,213 @@
+#include "MeshBoundsCalculator.h"
+
+#include "graphics/skeleton/Skeleton.h"
+#include "graphics/mesh/Mesh.h"
+#include "graphics/animation/Animation.h"
+#include "common/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace CE
+{
+	// Weights below this don't move a vertex enough to count as an influence.
+	static const float INFLUENCE_WEIGHT_EPSILON = 1e-4f;
+
+	// Rate at which clips are sampled. Matches the rate the engine bakes
+	// animation textures at; the bounds are not padded for motion between samples.
+	static const float BOUNDS_SAMPLE_RATE = 30.f;
+
+	// Appends each vertex of mesh, in the bind space of every joint that moves it.
+	static void CollectJointPoints(
+		const Skeleton& skeleton,
+		const Mesh& mesh,
+		std::vector<std::vector<glm::vec3>>& outJointPoints)
+	{
+		for (const Vertex1P1UV4J& vertex : mesh.m_vertices)
+		{
+			// The fourth weight is implicit.
+			const float weights[4] = {
+				vertex.jointWeights[0],
+				vertex.jointWeights[1],
+				vertex.jointWeights[2],
+				1.f - (vertex.jointWeights[0] + vertex.jointWeights[1] + vertex.jointWeights[2])
+			};
+
+			for (unsigned k = 0; k < 4; ++k)
+			{
+				const unsigned joint = vertex.jointIndices[k];
+				if (weights[k] > INFLUENCE_WEIGHT_EPSILON && joint < outJointPoints.size())
+				{
+					const glm::vec4 point = skeleton.joints[joint].inverseBindPose * glm::vec4(vertex.position, 1.f);
+					outJointPoints[joint].push_back(glm::vec3(point));
+				}
+			}
+		}
+	}
+
+	// A joint's sphere is carried through every model pose, so it has to
+	// contain every vertex the joint moves in the joint's own bind space.
+	static void ExpandSphere(glm::vec4& sphere, const std::vector<glm::vec3>& points)
+	{
+		if (points.empty())
+		{
+			return;
+		}
+
+		glm::vec3 min = points.front();
+		glm::vec3 max = points.front();
+		for (const glm::vec3& point : points)
+		{
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		const glm::vec3 center = (min + max) * 0.5f;
+		float radius = 0.f;
+		for (const glm::vec3& point : points)
+		{
+			radius = std::max(radius, glm::length(point - center));
+		}
+
+		sphere = glm::vec4(center, radius);
+	}
+
+	static float MaxAxisScale(const glm::mat4& matrix)
+	{
+		return std::max(
+			glm::length(glm::vec3(matrix[0])),
+			std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+	}
+
+	MeshBoundsCalculator::MeshBoundsCalculator(Skeleton* skeleton, Meshes* meshes, const Animations* animations)
+		: m_skeleton(skeleton)
+		, m_meshes(meshes)
+		, m_animations(animations)
+	{
+
+	}
+
+	void MeshBoundsCalculator::CalculateBounds()
+	{
+		const size_t jointCount = m_skeleton->joints.size();
+
+		// Spheres of joints that influence nothing keep a negative radius.
+		m_skeleton->jointBounds.assign(jointCount, glm::vec4(0.f, 0.f, 0.f, -1.f));
+
+		std::vector<std::vector<glm::vec4>> meshesJointBounds(m_meshes->size());
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			Mesh& mesh = (*m_meshes)[i];
+			CalculateJointBounds(mesh, meshesJointBounds[i]);
+			CalculateBindPoseBounds(mesh);
+		}
+
+		// The skeleton's spheres cover the joint's vertices across every mesh.
+		std::vector<std::vector<glm::vec3>> jointPoints(jointCount);
+		for (const Mesh& mesh : *m_meshes)
+		{
+			CollectJointPoints(*m_skeleton, mesh, jointPoints);
+		}
+
+		for (size_t j = 0; j < jointCount; ++j)
+		{
+			ExpandSphere(m_skeleton->jointBounds[j], jointPoints[j]);
+		}
+
+		for (const Animation& animation : *m_animations)
+		{
+			SampleAnimation(animation, meshesJointBounds);
+		}
+
+		for (const Mesh& mesh : *m_meshes)
+		{
+			printf(
+				"Bounds: (%.1f, %.1f, %.1f) to (%.1f, %.1f, %.1f)\n",
+				mesh.m_boundsMin.x, mesh.m_boundsMin.y, mesh.m_boundsMin.z,
+				mesh.m_boundsMax.x, mesh.m_boundsMax.y, mesh.m_boundsMax.z);
+		}
+	}
+
+	void MeshBoundsCalculator::CalculateJointBounds(
+		const Mesh& mesh,
+		std::vector<glm::vec4>& outMeshJointBounds)
+	{
+		const size_t jointCount = m_skeleton->joints.size();
+		std::vector<std::vector<glm::vec3>> jointPoints(jointCount);
+		CollectJointPoints(*m_skeleton, mesh, jointPoints);
+
+		outMeshJointBounds.assign(jointCount, glm::vec4(0.f, 0.f, 0.f, -1.f));
+		for (size_t j = 0; j < jointCount; ++j)
+		{
+			ExpandSphere(outMeshJointBounds[j], jointPoints[j]);
+		}
+	}
+
+	void MeshBoundsCalculator::CalculateBindPoseBounds(Mesh& mesh)
+	{
+		for (const Vertex1P1UV4J& vertex : mesh.m_vertices)
+		{
+			mesh.m_boundsMin = glm::min(mesh.m_boundsMin, vertex.position);
+			mesh.m_boundsMax = glm::max(mesh.m_boundsMax, vertex.position);
+		}
+	}
+
+	void MeshBoundsCalculator::ExpandBounds(
+		Mesh& mesh,
+		const std::vector<glm::vec4>& meshJointBounds,
+		const std::vector<glm::mat4>& modelPoses)
+	{
+		for (size_t j = 0; j < meshJointBounds.size(); ++j)
+		{
+			const glm::vec4& sphere = meshJointBounds[j];
+			if (sphere.w < 0.f)
+			{
+				continue;
+			}
+
+			const glm::vec3 center = glm::vec3(modelPoses[j] * glm::vec4(glm::vec3(sphere), 1.f));
+			const glm::vec3 radius = glm::vec3(sphere.w * MaxAxisScale(modelPoses[j]));
+			mesh.m_boundsMin = glm::min(mesh.m_boundsMin, center - radius);
+			mesh.m_boundsMax = glm::max(mesh.m_boundsMax, center + radius);
+		}
+	}
+
+	void MeshBoundsCalculator::SampleAnimation(
+		const Animation& animation,
+		const std::vector<std::vector<glm::vec4>>& meshesJointBounds)
+	{
+		const size_t jointCount = m_skeleton->joints.size();
+		if (animation.translations.size() < jointCount
+			|| animation.rotations.size() < jointCount
+			|| animation.scales.size() < jointCount)
+		{
+			printf("Skipping bounds of animation %s: missing joint tracks.\n", animation.name.c_str());
+			return;
+		}
+
+		const unsigned frameCount = static_cast<unsigned>(std::ceil(animation.duration * BOUNDS_SAMPLE_RATE)) + 1;
+		std::vector<glm::mat4> modelPoses(jointCount);
+
+		for (unsigned frame = 0; frame < frameCount; ++frame)
+		{
+			const float time = std::min(frame / BOUNDS_SAMPLE_RATE, animation.duration);
+
+			for (size_t i = 0; i < jointCount; ++i)
+			{
+				const glm::vec3 translation = SampleKeys(animation.translations[i], time, &TranslationKey::translation, LerpTranslation);
+				const glm::quat rotation = SampleKeys(animation.rotations[i], time, &RotationKey::rotation, LerpRotation);
+				const glm::vec3 scale = SampleKeys(animation.scales[i], time, &ScaleKey::scale, LerpScale);
+
+				const glm::mat4 localPose = ToAffineMatrix(translation, rotation, scale);
+				const short parentIndex = m_skeleton->joints[i].parentIndex;
+				modelPoses[i] = parentIndex == -1 ? localPose : modelPoses[parentIndex] * localPose;
+			}
+
+			for (size_t m = 0; m < m_meshes->size(); ++m)
+			{
+				ExpandBounds((*m_meshes)[m], meshesJointBounds[m], modelPoses);
+			}
+		}
+	}
+}
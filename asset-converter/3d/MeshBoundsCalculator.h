@@ -0,0 +1,47 @@
+#ifndef _CE_MESH_BOUNDS_CALCULATOR_H_
+#define _CE_MESH_BOUNDS_CALCULATOR_H_
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace CE
+{
+	struct Skeleton;
+	struct Mesh;
+	typedef std::vector<Mesh> Meshes;
+	struct Animation;
+	typedef std::vector<Animation> Animations;
+
+	// Computes a bounding sphere per joint, around the vertices it influences,
+	// and a model-space box per mesh that contains the mesh in its bind pose and
+	// in every sampled frame of every animation. The engine culls with the boxes
+	// without evaluating a pose.
+	class MeshBoundsCalculator
+	{
+	public:
+		MeshBoundsCalculator(Skeleton* skeleton, Meshes* meshes, const Animations* animations);
+
+		void CalculateBounds();
+
+	private:
+		void CalculateJointBounds(
+			const Mesh& mesh,
+			std::vector<glm::vec4>& outMeshJointBounds);
+		void CalculateBindPoseBounds(Mesh& mesh);
+		void ExpandBounds(
+			Mesh& mesh,
+			const std::vector<glm::vec4>& meshJointBounds,
+			const std::vector<glm::mat4>& modelPoses);
+		void SampleAnimation(
+			const Animation& animation,
+			const std::vector<std::vector<glm::vec4>>& meshesJointBounds);
+
+	private:
+		Skeleton* m_skeleton;
+		Meshes* m_meshes;
+		const Animations* m_animations;
+	};
+}
+
+#endif // _CE_MESH_BOUNDS_CALCULATOR_H_
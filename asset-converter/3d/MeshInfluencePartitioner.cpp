@@ -0,0 +1,100 @@
+#include "MeshInfluencePartitioner.h"
+
+#include "graphics/mesh/Mesh.h"
+
+#include <cstdio>
+
+namespace CE
+{
+	// Weights below this are treated as unused slots.
+	static const float INFLUENCE_WEIGHT_EPSILON = 1e-4f;
+
+	static unsigned CountInfluences(const Vertex1P1UV4J& vertex)
+	{
+		// The fourth weight is implicit, and the weights are sorted by decreasing weight.
+		const float weights[4] = {
+			vertex.jointWeights[0],
+			vertex.jointWeights[1],
+			vertex.jointWeights[2],
+			1.f - (vertex.jointWeights[0] + vertex.jointWeights[1] + vertex.jointWeights[2])
+		};
+
+		unsigned influences = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			if (weights[i] > INFLUENCE_WEIGHT_EPSILON)
+			{
+				++influences;
+			}
+		}
+		return influences;
+	}
+
+	static unsigned SelectInfluenceRange(unsigned influences)
+	{
+		if (influences <= 1)
+		{
+			return 0;
+		}
+		if (influences == 2)
+		{
+			return 1;
+		}
+		return 2;
+	}
+
+	MeshInfluencePartitioner::MeshInfluencePartitioner(Meshes* meshes)
+		: m_meshes(meshes)
+	{
+
+	}
+
+	void MeshInfluencePartitioner::PartitionMeshes()
+	{
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			PartitionMesh((*m_meshes)[i]);
+		}
+	}
+
+	void MeshInfluencePartitioner::PartitionMesh(Mesh& mesh)
+	{
+		std::vector<unsigned> vertexRanges(mesh.m_vertices.size());
+		mesh.m_influenceRangeCounts.assign(3, 0);
+
+		for (size_t i = 0; i < mesh.m_vertices.size(); ++i)
+		{
+			vertexRanges[i] = SelectInfluenceRange(CountInfluences(mesh.m_vertices[i]));
+			++mesh.m_influenceRangeCounts[vertexRanges[i]];
+		}
+
+		unsigned rangeStarts[3] = {
+			0,
+			mesh.m_influenceRangeCounts[0],
+			mesh.m_influenceRangeCounts[0] + mesh.m_influenceRangeCounts[1]
+		};
+
+		// Stable within each range, so the original vertex locality is kept.
+		std::vector<Vertex1P1UV4J> partitionedVertices(mesh.m_vertices.size());
+		std::vector<unsigned> remap(mesh.m_vertices.size());
+		for (size_t i = 0; i < mesh.m_vertices.size(); ++i)
+		{
+			const unsigned newIndex = rangeStarts[vertexRanges[i]]++;
+			partitionedVertices[newIndex] = mesh.m_vertices[i];
+			remap[i] = newIndex;
+		}
+
+		for (unsigned& index : mesh.m_indices)
+		{
+			index = remap[index];
+		}
+
+		mesh.m_vertices.swap(partitionedVertices);
+
+		printf(
+			"Influence ranges: %u x1, %u x2, %u x4\n",
+			mesh.m_influenceRangeCounts[0],
+			mesh.m_influenceRangeCounts[1],
+			mesh.m_influenceRangeCounts[2]);
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef _CE_MESH_INFLUENCE_PARTITIONER_H_
+#define _CE_MESH_INFLUENCE_PARTITIONER_H_
+
+#include <vector>
+
+namespace CE
+{
+	struct Mesh;
+	typedef std::vector<Mesh> Meshes;
+
+	// Reorders each mesh's vertices into ranges of 1, 2 and up to 4 joint
+	// influences, so the engine can skin each range with a shader that only
+	// does as many palette fetches as the range needs.
+	class MeshInfluencePartitioner
+	{
+	public:
+		MeshInfluencePartitioner(Meshes* meshes);
+
+		void PartitionMeshes();
+
+	private:
+		void PartitionMesh(Mesh& mesh);
+
+	private:
+		Meshes* m_meshes;
+	};
+}
+
+#endif // _CE_MESH_INFLUENCE_PARTITIONER_H_
@@ -0,0 +1,422 @@
+#include "MeshOptimizer.h"
+
+#include "graphics/mesh/Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace CE
+{
+	// Size of the modelled LRU cache that triangles are ordered for.
+	static const int VERTEX_CACHE_SIZE = 32;
+
+	// ACMR is reported against a FIFO cache, which is closer to most hardware.
+	static const size_t ACMR_FIFO_SIZE = 16;
+
+	// Clusters smaller than this are not split off for overdraw sorting, so
+	// sorting them does not throw away the cache order.
+	static const size_t MIN_OVERDRAW_CLUSTER_TRIANGLES = 64;
+
+	// Average cache misses per triangle; 0.5 is ideal for a regular grid, 3 is the worst case.
+	static float CalculateAcmr(const std::vector<unsigned>& indices, size_t vertexCount)
+	{
+		if (indices.empty())
+		{
+			return 0.f;
+		}
+
+		std::vector<size_t> cacheTimestamps(vertexCount, 0);
+		size_t time = ACMR_FIFO_SIZE + 1;
+		size_t misses = 0;
+		for (unsigned index : indices)
+		{
+			// A vertex is in the FIFO if fewer than ACMR_FIFO_SIZE misses happened since it was added.
+			if (time - cacheTimestamps[index] > ACMR_FIFO_SIZE)
+			{
+				cacheTimestamps[index] = time++;
+				++misses;
+			}
+		}
+
+		return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+	}
+
+	// Tom Forsyth's linear-speed vertex cache optimization.
+	static float ScoreVertex(int cachePosition, unsigned remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.f;
+		}
+
+		float score = 0.f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// The last triangle's vertices score the same, whatever their order.
+				score = 0.75f;
+			}
+			else
+			{
+				const float scaler = 1.f / (VERTEX_CACHE_SIZE - 3);
+				score = std::pow(1.f - (cachePosition - 3) * scaler, 1.5f);
+			}
+		}
+
+		// Favour vertices with few triangles left, so they don't get stranded.
+		score += 2.f / std::sqrt(static_cast<float>(remainingTriangles));
+		return score;
+	}
+
+	MeshOptimizer::MeshOptimizer(Meshes* meshes)
+		: m_meshes(meshes)
+	{
+
+	}
+
+	void MeshOptimizer::OptimizeMeshes()
+	{
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			OptimizeMesh((*m_meshes)[i]);
+		}
+	}
+
+	void MeshOptimizer::ShortenIndices()
+	{
+		for (Mesh& mesh : *m_meshes)
+		{
+			if (mesh.m_vertices.size() > std::numeric_limits<uint16_t>::max())
+			{
+				continue;
+			}
+
+			mesh.m_shortIndices.assign(mesh.m_indices.begin(), mesh.m_indices.end());
+			mesh.m_indices.clear();
+			mesh.m_indices.shrink_to_fit();
+		}
+	}
+
+	void MeshOptimizer::OptimizeMesh(Mesh& mesh)
+	{
+		if (mesh.m_indices.size() < 3)
+		{
+			return;
+		}
+
+		const float acmrBefore = CalculateAcmr(mesh.m_indices, mesh.m_vertices.size());
+
+		std::vector<unsigned> lodIndexCounts = mesh.m_lodIndexCounts;
+		if (lodIndexCounts.empty())
+		{
+			lodIndexCounts.push_back(static_cast<unsigned>(mesh.m_indices.size()));
+		}
+
+		std::vector<unsigned> newIndices;
+		newIndices.reserve(mesh.m_indices.size());
+		size_t firstIndex = 0;
+		for (unsigned indexCount : lodIndexCounts)
+		{
+			std::vector<unsigned> lodIndices(
+				mesh.m_indices.begin() + firstIndex,
+				mesh.m_indices.begin() + firstIndex + indexCount);
+			OptimizeVertexCache(mesh, lodIndices);
+			OptimizeOverdraw(mesh, lodIndices);
+			newIndices.insert(newIndices.end(), lodIndices.begin(), lodIndices.end());
+			firstIndex += indexCount;
+		}
+		mesh.m_indices.swap(newIndices);
+
+		// The finest level uses every vertex the others do, so it sets the fetch order.
+		OptimizeVertexFetch(mesh);
+
+		const float acmrAfter = CalculateAcmr(mesh.m_indices, mesh.m_vertices.size());
+
+		printf("ACMR: %.3f -> %.3f (%zu triangles)\n", acmrBefore, acmrAfter, mesh.m_indices.size() / 3);
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(const Mesh& mesh, std::vector<unsigned>& indices)
+	{
+		const size_t vertexCount = mesh.m_vertices.size();
+		const size_t triangleCount = indices.size() / 3;
+
+		// Triangles adjacent to each vertex, as offsets into one array.
+		std::vector<unsigned> remainingTriangles(vertexCount, 0);
+		for (unsigned index : indices)
+		{
+			++remainingTriangles[index];
+		}
+
+		std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remainingTriangles[i];
+		}
+
+		std::vector<unsigned> adjacency(indices.size());
+		std::vector<size_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const unsigned vertex = indices[triangle * 3 + corner];
+				adjacency[adjacencyFill[vertex]++] = static_cast<unsigned>(triangle);
+			}
+		}
+
+		std::vector<int> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			vertexScores[i] = ScoreVertex(-1, remainingTriangles[i]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			triangleScores[triangle] =
+				vertexScores[indices[triangle * 3]] +
+				vertexScores[indices[triangle * 3 + 1]] +
+				vertexScores[indices[triangle * 3 + 2]];
+		}
+
+		std::vector<unsigned> newIndices;
+		newIndices.reserve(indices.size());
+
+		// The cache holds up to three more entries while a triangle is being added.
+		std::vector<unsigned> cache;
+		cache.reserve(VERTEX_CACHE_SIZE + 3);
+
+		size_t nextUnemittedTriangle = 0;
+		int bestTriangle = -1;
+
+		for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			if (bestTriangle < 0)
+			{
+				// Nothing in the cache is adjacent to a remaining triangle; take the best of the rest.
+				float bestScore = -1.f;
+				for (size_t triangle = nextUnemittedTriangle; triangle < triangleCount; ++triangle)
+				{
+					if (!emitted[triangle] && triangleScores[triangle] > bestScore)
+					{
+						bestScore = triangleScores[triangle];
+						bestTriangle = static_cast<int>(triangle);
+					}
+				}
+			}
+
+			const size_t triangle = static_cast<size_t>(bestTriangle);
+			emitted[triangle] = true;
+			while (nextUnemittedTriangle < triangleCount && emitted[nextUnemittedTriangle])
+			{
+				++nextUnemittedTriangle;
+			}
+
+			// Move the triangle's vertices to the front of the cache, and retire the triangle from their adjacency.
+			// A degenerate triangle lists a vertex, and is in its adjacency, once per corner that repeats it.
+			std::vector<unsigned> newCache;
+			newCache.reserve(VERTEX_CACHE_SIZE + 3);
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const unsigned vertex = indices[triangle * 3 + corner];
+				newIndices.push_back(vertex);
+				if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+				{
+					newCache.push_back(vertex);
+				}
+
+				// Adjacency order doesn't matter, so the last entry fills the gap.
+				const auto begin = adjacency.begin() + adjacencyOffsets[vertex];
+				const auto end = begin + remainingTriangles[vertex];
+				std::iter_swap(std::find(begin, end, static_cast<unsigned>(triangle)), end - 1);
+				--remainingTriangles[vertex];
+			}
+			for (unsigned vertex : cache)
+			{
+				if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			// Vertices pushed out of the cache lose their cache score.
+			for (size_t i = VERTEX_CACHE_SIZE; i < newCache.size(); ++i)
+			{
+				cachePositions[newCache[i]] = -1;
+				vertexScores[newCache[i]] = ScoreVertex(-1, remainingTriangles[newCache[i]]);
+			}
+			if (newCache.size() > static_cast<size_t>(VERTEX_CACHE_SIZE))
+			{
+				newCache.resize(VERTEX_CACHE_SIZE);
+			}
+			cache.swap(newCache);
+
+			for (size_t i = 0; i < cache.size(); ++i)
+			{
+				cachePositions[cache[i]] = static_cast<int>(i);
+				vertexScores[cache[i]] = ScoreVertex(static_cast<int>(i), remainingTriangles[cache[i]]);
+			}
+
+			// Only triangles touching the cache changed score, so the next triangle is one of them.
+			bestTriangle = -1;
+			float bestScore = -1.f;
+			for (unsigned vertex : cache)
+			{
+				const size_t begin = adjacencyOffsets[vertex];
+				const size_t end = begin + remainingTriangles[vertex];
+				for (size_t i = begin; i < end; ++i)
+				{
+					const unsigned adjacentTriangle = adjacency[i];
+					const float score =
+						vertexScores[indices[adjacentTriangle * 3]] +
+						vertexScores[indices[adjacentTriangle * 3 + 1]] +
+						vertexScores[indices[adjacentTriangle * 3 + 2]];
+					triangleScores[adjacentTriangle] = score;
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = static_cast<int>(adjacentTriangle);
+					}
+				}
+			}
+		}
+
+		indices.swap(newIndices);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(const Mesh& mesh, std::vector<unsigned>& indices)
+	{
+		const size_t triangleCount = indices.size() / 3;
+
+		// Split the cache-ordered triangles into clusters where the cache
+		// starts over anyway, so reordering clusters costs few extra misses.
+		std::vector<size_t> clusterStarts;
+		std::vector<size_t> cacheTimestamps(mesh.m_vertices.size(), 0);
+		size_t time = ACMR_FIFO_SIZE + 1;
+		size_t clusterStart = 0;
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			unsigned misses = 0;
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const unsigned vertex = indices[triangle * 3 + corner];
+				if (time - cacheTimestamps[vertex] > ACMR_FIFO_SIZE)
+				{
+					cacheTimestamps[vertex] = time++;
+					++misses;
+				}
+			}
+
+			if (triangle == 0 || (misses == 3 && triangle - clusterStart >= MIN_OVERDRAW_CLUSTER_TRIANGLES))
+			{
+				clusterStart = triangle;
+				clusterStarts.push_back(triangle);
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		const size_t clusterCount = clusterStarts.size() - 1;
+		if (clusterCount < 2)
+		{
+			return;
+		}
+
+		// Clusters facing away from the mesh's center are likely to occlude the
+		// ones facing toward it, so they are drawn first.
+		glm::vec3 meshCentroid(0.f);
+		for (const Vertex1P1UV4J& vertex : mesh.m_vertices)
+		{
+			meshCentroid += vertex.position;
+		}
+		meshCentroid /= static_cast<float>(mesh.m_vertices.size());
+
+		std::vector<float> clusterSortKeys(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+		{
+			glm::vec3 centroid(0.f);
+			glm::vec3 normal(0.f);
+			float area = 0.f;
+			for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+			{
+				const glm::vec3& p0 = mesh.m_vertices[indices[triangle * 3]].position;
+				const glm::vec3& p1 = mesh.m_vertices[indices[triangle * 3 + 1]].position;
+				const glm::vec3& p2 = mesh.m_vertices[indices[triangle * 3 + 2]].position;
+
+				// Twice the area-weighted normal; its length is twice the area.
+				const glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+				const float triangleArea = glm::length(triangleNormal);
+
+				centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+				normal += triangleNormal;
+				area += triangleArea;
+			}
+
+			if (area > 0.f)
+			{
+				centroid /= area;
+			}
+			const float normalLength = glm::length(normal);
+			if (normalLength > 0.f)
+			{
+				normal /= normalLength;
+			}
+
+			clusterSortKeys[cluster] = glm::dot(centroid - meshCentroid, normal);
+		}
+
+		std::vector<size_t> clusterOrder(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+		{
+			clusterOrder[cluster] = cluster;
+		}
+		std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](size_t lhs, size_t rhs)
+		{
+			return clusterSortKeys[lhs] > clusterSortKeys[rhs];
+		});
+
+		std::vector<unsigned> newIndices;
+		newIndices.reserve(indices.size());
+		for (size_t cluster : clusterOrder)
+		{
+			newIndices.insert(
+				newIndices.end(),
+				indices.begin() + clusterStarts[cluster] * 3,
+				indices.begin() + clusterStarts[cluster + 1] * 3);
+		}
+
+		indices.swap(newIndices);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(Mesh& mesh)
+	{
+		// Vertices in order of first use; vertices no triangle uses are dropped.
+		const unsigned unused = std::numeric_limits<unsigned>::max();
+		std::vector<unsigned> remap(mesh.m_vertices.size(), unused);
+		std::vector<Vertex1P1UV4J> newVertices;
+		newVertices.reserve(mesh.m_vertices.size());
+
+		for (unsigned& index : mesh.m_indices)
+		{
+			if (remap[index] == unused)
+			{
+				remap[index] = static_cast<unsigned>(newVertices.size());
+				newVertices.push_back(mesh.m_vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		if (newVertices.size() != mesh.m_vertices.size())
+		{
+			printf("Dropped %zu unused vertices\n", mesh.m_vertices.size() - newVertices.size());
+		}
+
+		mesh.m_vertices.swap(newVertices);
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef _CE_MESH_OPTIMIZER_H_
+#define _CE_MESH_OPTIMIZER_H_
+
+#include <vector>
+
+namespace CE
+{
+	struct Mesh;
+	typedef std::vector<Mesh> Meshes;
+
+	// Reorders each mesh's triangles for post-transform vertex cache hits,
+	// then clusters of them for less overdraw, then its vertices in order of
+	// first use for fetch locality. Each level of detail is ordered on its own.
+	// Run before anything that relies on the vertex order, such as
+	// MeshInfluencePartitioner.
+	class MeshOptimizer
+	{
+	public:
+		MeshOptimizer(Meshes* meshes);
+
+		void OptimizeMeshes();
+
+		// Moves indices into 16 bits for every mesh with few enough vertices.
+		// Run last, since the other stages only work on 32 bit indices.
+		void ShortenIndices();
+
+	private:
+		void OptimizeMesh(Mesh& mesh);
+		void OptimizeVertexCache(const Mesh& mesh, std::vector<unsigned>& indices);
+		void OptimizeOverdraw(const Mesh& mesh, std::vector<unsigned>& indices);
+		void OptimizeVertexFetch(Mesh& mesh);
+
+	private:
+		Meshes* m_meshes;
+	};
+}
+
+#endif // _CE_MESH_OPTIMIZER_H_
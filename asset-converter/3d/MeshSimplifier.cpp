@@ -0,0 +1,457 @@
+#include "MeshSimplifier.h"
+
+#include "graphics/mesh/Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+
+namespace CE
+{
+	// Levels of detail per mesh, including the full resolution one.
+	static const unsigned MESH_LOD_COUNT = 4;
+
+	// Each level aims for this fraction of the previous level's triangles.
+	static const float LOD_TRIANGLE_RATIO = 0.5f;
+
+	// A level that keeps more than this fraction of the previous level's
+	// triangles isn't worth its indices, and ends the chain.
+	static const float MIN_LOD_REDUCTION = 0.8f;
+
+	// Largest collapse error of the first generated level, as a fraction of
+	// the mesh's bounding radius. Each further level allows twice as much.
+	static const float LOD_BASE_ERROR = 0.01f;
+
+	// Sum of absolute weight differences, over 0 to 2, above which two
+	// vertices deform too differently to be merged.
+	static const float MAX_SKIN_WEIGHT_DISTANCE = 0.5f;
+
+	// Symmetric 4x4 matrix of the summed squared distances to a set of planes.
+	struct Quadric
+	{
+		double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+		double a11 = 0, a12 = 0, a13 = 0;
+		double a22 = 0, a23 = 0;
+		double a33 = 0;
+
+		void AddPlane(const glm::vec3& normal, float distance)
+		{
+			const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+			a00 += a * a; a01 += a * b; a02 += a * c; a03 += a * d;
+			a11 += b * b; a12 += b * c; a13 += b * d;
+			a22 += c * c; a23 += c * d;
+			a33 += d * d;
+		}
+
+		void Add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+			a11 += other.a11; a12 += other.a12; a13 += other.a13;
+			a22 += other.a22; a23 += other.a23;
+			a33 += other.a33;
+		}
+
+		double Evaluate(const glm::vec3& point) const
+		{
+			const double x = point.x, y = point.y, z = point.z;
+			return x * x * a00 + y * y * a11 + z * z * a22
+				+ 2.0 * (x * y * a01 + x * z * a02 + y * z * a12)
+				+ 2.0 * (x * a03 + y * a13 + z * a23)
+				+ a33;
+		}
+	};
+
+	struct Collapse
+	{
+		float cost;
+		unsigned from;
+		unsigned to;
+		unsigned fromVersion;
+		unsigned toVersion;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	static float SkinWeightDistance(const Vertex1P1UV4J& lhs, const Vertex1P1UV4J& rhs)
+	{
+		// The fourth weight is implicit, and a joint may appear in any slot.
+		const float lhsWeights[4] = {
+			lhs.jointWeights[0],
+			lhs.jointWeights[1],
+			lhs.jointWeights[2],
+			1.f - (lhs.jointWeights[0] + lhs.jointWeights[1] + lhs.jointWeights[2])
+		};
+		const float rhsWeights[4] = {
+			rhs.jointWeights[0],
+			rhs.jointWeights[1],
+			rhs.jointWeights[2],
+			1.f - (rhs.jointWeights[0] + rhs.jointWeights[1] + rhs.jointWeights[2])
+		};
+
+		std::map<unsigned, float> differences;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			differences[lhs.jointIndices[i]] += lhsWeights[i];
+			differences[rhs.jointIndices[i]] -= rhsWeights[i];
+		}
+
+		float distance = 0.f;
+		for (const auto& difference : differences)
+		{
+			distance += std::abs(difference.second);
+		}
+		return distance;
+	}
+
+	static uint64_t EdgeKey(unsigned a, unsigned b)
+	{
+		return a < b
+			? (static_cast<uint64_t>(a) << 32) | b
+			: (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	// Seam vertices share their position with another vertex, and border
+	// vertices sit on an edge with a single triangle. Moving either opens a crack.
+	static std::vector<bool> FindLockedVertices(const Mesh& mesh, const std::vector<unsigned>& indices)
+	{
+		std::vector<bool> locked(mesh.m_vertices.size(), false);
+
+		std::map<std::tuple<float, float, float>, unsigned> firstAtPosition;
+		for (unsigned i = 0; i < mesh.m_vertices.size(); ++i)
+		{
+			const glm::vec3& position = mesh.m_vertices[i].position;
+			auto inserted = firstAtPosition.insert(std::make_pair(std::make_tuple(position.x, position.y, position.z), i));
+			if (!inserted.second)
+			{
+				locked[i] = true;
+				locked[inserted.first->second] = true;
+			}
+		}
+
+		std::unordered_map<uint64_t, unsigned> edgeTriangles;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				++edgeTriangles[EdgeKey(indices[i + corner], indices[i + (corner + 1) % 3])];
+			}
+		}
+		for (const auto& edge : edgeTriangles)
+		{
+			if (edge.second == 1)
+			{
+				locked[static_cast<unsigned>(edge.first >> 32)] = true;
+				locked[static_cast<unsigned>(edge.first & 0xffffffff)] = true;
+			}
+		}
+
+		return locked;
+	}
+
+	// Greedily collapses the cheapest edge until targetTriangles remain, or
+	// the next collapse would move the surface further than maxError.
+	static std::vector<unsigned> SimplifyIndices(
+		const Mesh& mesh,
+		const std::vector<unsigned>& indices,
+		size_t targetTriangles,
+		float maxError)
+	{
+		const size_t vertexCount = mesh.m_vertices.size();
+		const size_t triangleCount = indices.size() / 3;
+		const std::vector<bool> locked = FindLockedVertices(mesh, indices);
+
+		std::vector<unsigned> triangles(indices);
+		std::vector<bool> removedTriangles(triangleCount, false);
+		std::vector<std::vector<unsigned>> vertexTriangles(vertexCount);
+		std::vector<Quadric> quadrics(vertexCount);
+
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			const glm::vec3& p0 = mesh.m_vertices[triangles[triangle * 3]].position;
+			const glm::vec3& p1 = mesh.m_vertices[triangles[triangle * 3 + 1]].position;
+			const glm::vec3& p2 = mesh.m_vertices[triangles[triangle * 3 + 2]].position;
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float length = glm::length(normal);
+			if (length > 0.f)
+			{
+				normal /= length;
+			}
+
+			Quadric quadric;
+			quadric.AddPlane(normal, -glm::dot(normal, p0));
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const unsigned vertex = triangles[triangle * 3 + corner];
+				quadrics[vertex].Add(quadric);
+				vertexTriangles[vertex].push_back(static_cast<unsigned>(triangle));
+			}
+		}
+
+		std::vector<unsigned> versions(vertexCount, 0);
+		std::vector<bool> removedVertices(vertexCount, false);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+
+		auto pushCollapse = [&](unsigned from, unsigned to)
+		{
+			if (locked[from]
+				|| SkinWeightDistance(mesh.m_vertices[from], mesh.m_vertices[to]) > MAX_SKIN_WEIGHT_DISTANCE)
+			{
+				return;
+			}
+
+			Quadric quadric = quadrics[from];
+			quadric.Add(quadrics[to]);
+			const float cost = static_cast<float>(std::max(quadric.Evaluate(mesh.m_vertices[to].position), 0.0));
+			collapses.push({ cost, from, to, versions[from], versions[to] });
+		};
+
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const unsigned a = triangles[triangle * 3 + corner];
+				const unsigned b = triangles[triangle * 3 + (corner + 1) % 3];
+				pushCollapse(a, b);
+				pushCollapse(b, a);
+			}
+		}
+
+		const float maxCost = maxError * maxError;
+		size_t liveTriangles = triangleCount;
+		std::vector<unsigned> neighbors;
+
+		while (liveTriangles > targetTriangles && !collapses.empty())
+		{
+			const Collapse collapse = collapses.top();
+			collapses.pop();
+
+			if (collapse.cost > maxCost)
+			{
+				break;
+			}
+
+			const unsigned from = collapse.from;
+			const unsigned to = collapse.to;
+			if (removedVertices[from] || removedVertices[to]
+				|| versions[from] != collapse.fromVersion || versions[to] != collapse.toVersion)
+			{
+				continue;
+			}
+
+			// Link condition: the edge's two ends may only share the neighbors of
+			// the triangles on the edge, or the collapse pinches the surface.
+			unsigned sharedTriangles = 0;
+			neighbors.clear();
+			for (unsigned triangle : vertexTriangles[from])
+			{
+				if (removedTriangles[triangle])
+				{
+					continue;
+				}
+				bool hasTo = false;
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const unsigned vertex = triangles[triangle * 3 + corner];
+					hasTo |= vertex == to;
+					if (vertex != from)
+					{
+						neighbors.push_back(vertex);
+					}
+				}
+				sharedTriangles += hasTo ? 1 : 0;
+			}
+			std::sort(neighbors.begin(), neighbors.end());
+			neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+			unsigned sharedNeighbors = 0;
+			for (unsigned neighbor : neighbors)
+			{
+				if (neighbor == to)
+				{
+					continue;
+				}
+				for (unsigned triangle : vertexTriangles[to])
+				{
+					if (!removedTriangles[triangle]
+						&& (triangles[triangle * 3] == neighbor || triangles[triangle * 3 + 1] == neighbor || triangles[triangle * 3 + 2] == neighbor))
+					{
+						++sharedNeighbors;
+						break;
+					}
+				}
+			}
+			if (sharedTriangles == 0 || sharedNeighbors > sharedTriangles)
+			{
+				continue;
+			}
+
+			// Triangles that move must not flip or degenerate.
+			bool flips = false;
+			for (unsigned triangle : vertexTriangles[from])
+			{
+				const unsigned* corners = &triangles[triangle * 3];
+				if (removedTriangles[triangle] || corners[0] == to || corners[1] == to || corners[2] == to)
+				{
+					continue;
+				}
+
+				glm::vec3 before[3];
+				glm::vec3 after[3];
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					before[corner] = mesh.m_vertices[corners[corner]].position;
+					after[corner] = corners[corner] == from ? mesh.m_vertices[to].position : before[corner];
+				}
+
+				const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				if (glm::dot(normalBefore, normalAfter) <= 0.f)
+				{
+					flips = true;
+					break;
+				}
+			}
+			if (flips)
+			{
+				continue;
+			}
+
+			for (unsigned triangle : vertexTriangles[from])
+			{
+				if (removedTriangles[triangle])
+				{
+					continue;
+				}
+
+				unsigned* corners = &triangles[triangle * 3];
+				if (corners[0] == to || corners[1] == to || corners[2] == to)
+				{
+					removedTriangles[triangle] = true;
+					--liveTriangles;
+					continue;
+				}
+
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					if (corners[corner] == from)
+					{
+						corners[corner] = to;
+					}
+				}
+				vertexTriangles[to].push_back(triangle);
+			}
+
+			removedVertices[from] = true;
+			quadrics[to].Add(quadrics[from]);
+			++versions[to];
+
+			std::vector<unsigned>& toTriangles = vertexTriangles[to];
+			toTriangles.erase(
+				std::remove_if(toTriangles.begin(), toTriangles.end(), [&removedTriangles](unsigned triangle)
+				{
+					return removedTriangles[triangle];
+				}),
+				toTriangles.end());
+
+			for (unsigned triangle : toTriangles)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const unsigned vertex = triangles[triangle * 3 + corner];
+					if (vertex != to)
+					{
+						pushCollapse(to, vertex);
+						pushCollapse(vertex, to);
+					}
+				}
+			}
+		}
+
+		std::vector<unsigned> simplifiedIndices;
+		simplifiedIndices.reserve(liveTriangles * 3);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			if (!removedTriangles[triangle])
+			{
+				simplifiedIndices.insert(
+					simplifiedIndices.end(),
+					triangles.begin() + triangle * 3,
+					triangles.begin() + triangle * 3 + 3);
+			}
+		}
+		return simplifiedIndices;
+	}
+
+	MeshSimplifier::MeshSimplifier(Meshes* meshes)
+		: m_meshes(meshes)
+	{
+
+	}
+
+	void MeshSimplifier::SimplifyMeshes()
+	{
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			SimplifyMesh((*m_meshes)[i]);
+		}
+	}
+
+	void MeshSimplifier::SimplifyMesh(Mesh& mesh)
+	{
+		if (mesh.m_indices.size() < 3 || mesh.m_vertices.empty())
+		{
+			return;
+		}
+
+		glm::vec3 min = mesh.m_vertices.front().position;
+		glm::vec3 max = min;
+		for (const Vertex1P1UV4J& vertex : mesh.m_vertices)
+		{
+			min = glm::min(min, vertex.position);
+			max = glm::max(max, vertex.position);
+		}
+		const float radius = glm::length(max - min) * 0.5f;
+
+		std::vector<unsigned> lodIndices = mesh.m_indices;
+		mesh.m_lodIndexCounts.assign(1, static_cast<unsigned>(mesh.m_indices.size()));
+
+		float maxError = LOD_BASE_ERROR * radius;
+		for (unsigned lod = 1; lod < MESH_LOD_COUNT; ++lod)
+		{
+			const size_t previousTriangles = lodIndices.size() / 3;
+			const size_t targetTriangles = static_cast<size_t>(previousTriangles * LOD_TRIANGLE_RATIO);
+
+			lodIndices = SimplifyIndices(mesh, lodIndices, targetTriangles, maxError);
+			if (lodIndices.empty() || lodIndices.size() / 3 > previousTriangles * MIN_LOD_REDUCTION)
+			{
+				break;
+			}
+
+			mesh.m_indices.insert(mesh.m_indices.end(), lodIndices.begin(), lodIndices.end());
+			mesh.m_lodIndexCounts.push_back(static_cast<unsigned>(lodIndices.size()));
+			maxError *= 2.f;
+		}
+
+		printf("LOD triangles:");
+		for (unsigned indexCount : mesh.m_lodIndexCounts)
+		{
+			printf(" %u", indexCount / 3);
+		}
+		printf("\n");
+
+		// A single level needs no chunk.
+		if (mesh.m_lodIndexCounts.size() == 1)
+		{
+			mesh.m_lodIndexCounts.clear();
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef _CE_MESH_SIMPLIFIER_H_
+#define _CE_MESH_SIMPLIFIER_H_
+
+#include <vector>
+
+namespace CE
+{
+	struct Mesh;
+	typedef std::vector<Mesh> Meshes;
+
+	// Generates coarser levels of detail for each mesh by quadric error edge
+	// collapses onto existing vertices, so every level shares the mesh's
+	// vertex buffer and only adds indices. UV seams and open borders are kept
+	// in place, and vertices only collapse onto vertices with similar skin
+	// weights. Run before MeshOptimizer, which orders each level on its own.
+	class MeshSimplifier
+	{
+	public:
+		MeshSimplifier(Meshes* meshes);
+
+		void SimplifyMeshes();
+
+	private:
+		void SimplifyMesh(Mesh& mesh);
+
+	private:
+		Meshes* m_meshes;
+	};
+}
+
+#endif // _CE_MESH_SIMPLIFIER_H_
@@ -0,0 +1,117 @@
+#include "MeshVertexQuantizer.h"
+
+#include "graphics/mesh/Mesh.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace CE
+{
+	static uint16_t QuantizeUnorm16(float value)
+	{
+		return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.f, 1.f) * 65535.f));
+	}
+
+	static void QuantizeWeights(const float (&jointWeights)[3], uint8_t (&outJointWeights)[4])
+	{
+		// The fourth weight is implicit, in the compact format too.
+		const float weights[4] = {
+			jointWeights[0],
+			jointWeights[1],
+			jointWeights[2],
+			1.f - (jointWeights[0] + jointWeights[1] + jointWeights[2])
+		};
+
+		int quantized[4];
+		int sum = 0;
+		int largest = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			quantized[i] = static_cast<int>(std::lround(glm::clamp(weights[i], 0.f, 1.f) * 255.f));
+			sum += quantized[i];
+			if (weights[i] > weights[largest])
+			{
+				largest = i;
+			}
+		}
+
+		// Rounding error goes to the largest weight, so the stored weights sum
+		// to exactly 255 with the implicit one, and it never goes negative.
+		quantized[largest] += 255 - sum;
+
+		outJointWeights[0] = static_cast<uint8_t>(quantized[0]);
+		outJointWeights[1] = static_cast<uint8_t>(quantized[1]);
+		outJointWeights[2] = static_cast<uint8_t>(quantized[2]);
+		outJointWeights[3] = 0;
+	}
+
+	MeshVertexQuantizer::MeshVertexQuantizer(Meshes* meshes)
+		: m_meshes(meshes)
+	{
+
+	}
+
+	void MeshVertexQuantizer::QuantizeMeshes()
+	{
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			QuantizeMesh((*m_meshes)[i]);
+		}
+	}
+
+	void MeshVertexQuantizer::QuantizeMesh(Mesh& mesh)
+	{
+		if (mesh.m_vertices.empty())
+		{
+			return;
+		}
+
+		glm::vec3 positionMin = mesh.m_vertices[0].position;
+		glm::vec3 positionMax = mesh.m_vertices[0].position;
+		for (const Vertex1P1UV4J& vertex : mesh.m_vertices)
+		{
+			positionMin = glm::min(positionMin, vertex.position);
+			positionMax = glm::max(positionMax, vertex.position);
+		}
+
+		// A flat mesh still needs a non-zero extent to divide by.
+		glm::vec3 positionExtent = positionMax - positionMin;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (positionExtent[axis] <= 0.f)
+			{
+				positionExtent[axis] = 1.f;
+			}
+		}
+
+		mesh.m_positionMin = positionMin;
+		mesh.m_positionExtent = positionExtent;
+
+		mesh.m_compactVertices.resize(mesh.m_vertices.size());
+		for (size_t i = 0; i < mesh.m_vertices.size(); ++i)
+		{
+			const Vertex1P1UV4J& vertex = mesh.m_vertices[i];
+			Vertex1P1UV4JCompact& compactVertex = mesh.m_compactVertices[i];
+
+			const glm::vec3 normalizedPosition = (vertex.position - positionMin) / positionExtent;
+			compactVertex.position[0] = QuantizeUnorm16(normalizedPosition.x);
+			compactVertex.position[1] = QuantizeUnorm16(normalizedPosition.y);
+			compactVertex.position[2] = QuantizeUnorm16(normalizedPosition.z);
+			compactVertex.position[3] = 0;
+
+			compactVertex.uv[0] = glm::packHalf1x16(vertex.uv[0]);
+			compactVertex.uv[1] = glm::packHalf1x16(vertex.uv[1]);
+
+			std::copy(vertex.jointIndices, vertex.jointIndices + 4, compactVertex.jointIndices);
+			QuantizeWeights(vertex.jointWeights, compactVertex.jointWeights);
+		}
+
+		printf(
+			"Compact vertices: %zu bytes -> %zu bytes\n",
+			mesh.m_vertices.size() * sizeof(Vertex1P1UV4J),
+			mesh.m_compactVertices.size() * sizeof(Vertex1P1UV4JCompact));
+	}
+}
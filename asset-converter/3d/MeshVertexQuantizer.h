@@ -0,0 +1,29 @@
+#ifndef _CE_MESH_VERTEX_QUANTIZER_H_
+#define _CE_MESH_VERTEX_QUANTIZER_H_
+
+#include <vector>
+
+namespace CE
+{
+	struct Mesh;
+	typedef std::vector<Mesh> Meshes;
+
+	// Fills each mesh's compact vertices from its float vertices: positions as
+	// unorm16 within the mesh bounds, UVs as half floats and weights as unorm8.
+	// Must run after anything that reorders vertices.
+	class MeshVertexQuantizer
+	{
+	public:
+		MeshVertexQuantizer(Meshes* meshes);
+
+		void QuantizeMeshes();
+
+	private:
+		void QuantizeMesh(Mesh& mesh);
+
+	private:
+		Meshes* m_meshes;
+	};
+}
+
+#endif // _CE_MESH_VERTEX_QUANTIZER_H_
@@ -1,6 +1,11 @@
 #include "2d/STBImageImporter.h"
 #include "3d/fbx/FBXImporter.h"
 #include "3d/AnimationOptimizer.h"
+#include "3d/MeshBoundsCalculator.h"
+#include "3d/MeshOptimizer.h"
+#include "3d/MeshSimplifier.h"
+#include "3d/MeshInfluencePartitioner.h"
+#include "3d/MeshVertexQuantizer.h"
 
 #include "graphics/ceasset/output/AssetExporter.h"
 
@@ -73,11 +78,41 @@ int main(int argc, char* argv[])
 			continue;
 		}
 
+		printf("Generating mesh LODs...\n");
+
+		CE::MeshSimplifier simplifier(&meshes);
+		simplifier.SimplifyMeshes();
+
+		printf("Optimizing meshes...\n");
+
+		CE::MeshOptimizer meshOptimizer(&meshes);
+		meshOptimizer.OptimizeMeshes();
+
+		printf("Partitioning meshes by joint influences...\n");
+
+		CE::MeshInfluencePartitioner partitioner(&meshes);
+		partitioner.PartitionMeshes();
+
+		printf("Quantizing vertices...\n");
+
+		CE::MeshVertexQuantizer quantizer(&meshes);
+		quantizer.QuantizeMeshes();
+
+		printf("Shortening indices...\n");
+
+		meshOptimizer.ShortenIndices();
+
 		printf("Optimizing animations...\n");
 
 		CE::AnimationOptimizer optimizer(&animations);
 		optimizer.OptimizeAnimations();
 
+		// After the animations are optimized, so the bounds cover the poses the engine plays.
+		printf("Calculating bounds...\n");
+
+		CE::MeshBoundsCalculator boundsCalculator(&skeleton, &meshes, &animations);
+		boundsCalculator.CalculateBounds();
+
 		printf("Exporting ceasset file...\n");
 
 		const auto position = fileName.find_last_of('.');
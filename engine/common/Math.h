@@ -4,6 +4,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <algorithm>
+#include <vector>
+
 namespace CE
 {
 	glm::mat4 ToAffineMatrix(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
@@ -11,6 +14,30 @@ namespace CE
 	glm::quat LerpRotation(const glm::quat& low, const glm::quat& high, float alpha);
 	glm::vec3 LerpScale(const glm::vec3& low, const glm::vec3& high, float alpha);
 	glm::vec3 Vec3Lerp(const glm::vec3& a, const glm::vec3& b, float alpha);
+
+	// Interpolates the value member of the two keys around time, clamping to the first and last key.
+	template<typename Key, typename Value, typename Lerp>
+	Value SampleKeys(const std::vector<Key>& keys, float time, Value Key::* value, Lerp lerp)
+	{
+		auto high = std::upper_bound(keys.begin(), keys.end(), time,
+			[](float time, const Key& key) -> bool {
+				return time < key.time;
+			});
+
+		if (high == keys.begin())
+		{
+			return keys.front().*value;
+		}
+
+		if (high == keys.end())
+		{
+			return keys.back().*value;
+		}
+
+		auto low = high - 1;
+		const float alpha = (time - low->time) / (high->time - low->time);
+		return lerp((*low).*value, (*high).*value, alpha);
+	}
 }
 
 #endif // _CE_MATH_H_
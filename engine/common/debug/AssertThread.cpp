@@ -12,6 +12,7 @@
 namespace CE
 {
 	std::thread::id MAIN_THREAD_ID;
+	std::thread::id RENDER_THREAD_ID;
 }
 
 
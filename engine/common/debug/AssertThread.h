@@ -8,6 +8,10 @@
 
 #define CE_REQUIRE_MAIN_THREAD() ((void)0)
 
+#define CE_SET_RENDER_THREAD() ((void)0)
+
+#define CE_REQUIRE_RENDER_THREAD() ((void)0)
+
 
 #else // NDEBUG
 
@@ -17,6 +21,7 @@
 namespace CE
 {
 	extern std::thread::id MAIN_THREAD_ID;
+	extern std::thread::id RENDER_THREAD_ID;
 }
 
 #define CE_SET_MAIN_THREAD() \
@@ -25,6 +30,12 @@ namespace CE
 #define CE_REQUIRE_MAIN_THREAD() \
 	CE_ASSERT(CE::MAIN_THREAD_ID == std::this_thread::get_id(), "CE_REQUIRE_MAIN_THREAD() called from invalid thread.")
 
+#define CE_SET_RENDER_THREAD() \
+	CE::RENDER_THREAD_ID = std::this_thread::get_id()
+
+#define CE_REQUIRE_RENDER_THREAD() \
+	CE_ASSERT(CE::RENDER_THREAD_ID == std::this_thread::get_id(), "CE_REQUIRE_RENDER_THREAD() called from invalid thread.")
+
 
 #endif // NDEBUG
 
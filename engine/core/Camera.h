@@ -21,6 +21,8 @@ namespace CE
 
 		glm::mat4 CreateViewMatrix();
 
+		const glm::vec3& GetLocation() const { return location; }
+
 	private:
 		void SwivelHorizontal(int x, float delta);
 		void SwivelVertical(int y, float delta);
@@ -6,6 +6,10 @@ namespace CE
 		: engineEventHandler(eventSystem, this)
 		, renderMode(0)
 		, renderBindPose(false)
+		, gpuAnimation(false)
+		// The instanced path skins in its vertex shader, without the skinned
+		// vertex cache or the influence count permutations.
+		, instancing(false)
 	{
 
 	}
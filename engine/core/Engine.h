@@ -14,6 +14,10 @@ namespace CE
 
 		bool IsRenderBindPose() const { return renderBindPose; }
 
+		bool IsGpuAnimation() const { return gpuAnimation; }
+
+		bool IsInstancing() const { return instancing; }
+
 	private:
 		EngineEventHandler engineEventHandler;
 
@@ -21,6 +25,10 @@ namespace CE
 
 		bool renderBindPose;
 
+		bool gpuAnimation;
+
+		bool instancing;
+
 		friend class EngineEventHandler;
 	};
 }
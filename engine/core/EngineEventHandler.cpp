@@ -18,6 +18,8 @@ namespace CE
 		eventSystem->RegisterListener(this, EventType::TOGGLE_PAUSE);
 		eventSystem->RegisterListener(this, EventType::SET_RENDER_MODE);
 		eventSystem->RegisterListener(this, EventType::TOGGLE_BIND_POSE);
+		eventSystem->RegisterListener(this, EventType::TOGGLE_GPU_ANIMATION);
+		eventSystem->RegisterListener(this, EventType::TOGGLE_INSTANCING);
 	}
 
 	void EngineEventHandler::OnEvent(const Event& event)
@@ -47,6 +49,18 @@ namespace CE
 				HandleToggleRenderBindPose();
 				break;
 			}
+
+			case EventType::TOGGLE_GPU_ANIMATION:
+			{
+				HandleToggleGpuAnimation();
+				break;
+			}
+
+			case EventType::TOGGLE_INSTANCING:
+			{
+				HandleToggleInstancing();
+				break;
+			}
 		}
 	}
 
@@ -76,6 +90,16 @@ namespace CE
 		SendBindPoseStateEvent();
 	}
 
+	void EngineEventHandler::HandleToggleGpuAnimation()
+	{
+		engine->gpuAnimation = !engine->gpuAnimation;
+	}
+
+	void EngineEventHandler::HandleToggleInstancing()
+	{
+		engine->instancing = !engine->instancing;
+	}
+
 	void EngineEventHandler::HandleSetRenderMode(const Event& event)
 	{
 		const SetRenderModeEvent& setRenderModeEvent = reinterpret_cast<const SetRenderModeEvent&>(event);
@@ -24,6 +24,8 @@ namespace CE
 		void HandleTogglePauseEvent();
 		void HandleSetRenderMode(const Event& event);
 		void HandleToggleRenderBindPose();
+		void HandleToggleGpuAnimation();
+		void HandleToggleInstancing();
 
 		EventSystem* eventSystem;
 		Engine* engine;
@@ -0,0 +1,104 @@
+#include "FrameTimeReport.h"
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+namespace CE
+{
+	static float Percentile(const std::vector<float>& sortedMilliseconds, float percentile)
+	{
+		size_t rank = (size_t) std::ceil(percentile * sortedMilliseconds.size());
+		return sortedMilliseconds[std::max<size_t>(rank, 1) - 1];
+	}
+
+	void FrameTimeReport::AddInfo(const char* key, const std::string& value)
+	{
+		stringInfo.emplace_back(key, value);
+	}
+
+	void FrameTimeReport::AddInfo(const char* key, float value)
+	{
+		numberInfo.emplace_back(key, value);
+	}
+
+	void FrameTimeReport::AddSeries(const char* name, const std::vector<float>& milliseconds)
+	{
+		series.emplace_back(name, Summarize(milliseconds));
+	}
+
+	FrameTimeSummary FrameTimeReport::Summarize(std::vector<float> milliseconds)
+	{
+		FrameTimeSummary summary = {};
+		summary.count = milliseconds.size();
+		if (milliseconds.empty())
+		{
+			return summary;
+		}
+
+		std::sort(milliseconds.begin(), milliseconds.end());
+		summary.mean = std::accumulate(milliseconds.begin(), milliseconds.end(), 0.f) / milliseconds.size();
+		summary.p50 = Percentile(milliseconds, 0.5f);
+		summary.p95 = Percentile(milliseconds, 0.95f);
+		summary.p99 = Percentile(milliseconds, 0.99f);
+		summary.max = milliseconds.back();
+		return summary;
+	}
+
+	bool FrameTimeReport::Write(const char* fileName) const
+	{
+		rapidjson::StringBuffer stringBuffer;
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(stringBuffer);
+
+		writer.StartObject();
+
+		for (const auto& info : stringInfo)
+		{
+			writer.Key(info.first.c_str());
+			writer.String(info.second.c_str());
+		}
+
+		for (const auto& info : numberInfo)
+		{
+			writer.Key(info.first.c_str());
+			writer.Double(info.second);
+		}
+
+		for (const auto& entry : series)
+		{
+			const FrameTimeSummary& summary = entry.second;
+			writer.Key(entry.first.c_str());
+			writer.StartObject();
+			writer.Key("count");
+			writer.Uint((unsigned) summary.count);
+			writer.Key("mean");
+			writer.Double(summary.mean);
+			writer.Key("p50");
+			writer.Double(summary.p50);
+			writer.Key("p95");
+			writer.Double(summary.p95);
+			writer.Key("p99");
+			writer.Double(summary.p99);
+			writer.Key("max");
+			writer.Double(summary.max);
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+
+		std::ofstream stream(fileName);
+		if (!stream.is_open())
+		{
+			printf("Unable to write frame time report %s\n", fileName);
+			return false;
+		}
+
+		stream << stringBuffer.GetString() << '\n';
+		return true;
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef _CE_FRAME_TIME_REPORT_H_
+#define _CE_FRAME_TIME_REPORT_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CE
+{
+	struct FrameTimeSummary
+	{
+		size_t count;
+		float mean;
+		float p50;
+		float p95;
+		float p99;
+		float max;
+	};
+
+	// Frame time statistics of a benchmark run, written as a JSON object with
+	// a summary per series. Series are in milliseconds, or per-frame counts.
+	class FrameTimeReport
+	{
+	public:
+		void AddInfo(const char* key, const std::string& value);
+		void AddInfo(const char* key, float value);
+		void AddSeries(const char* name, const std::vector<float>& milliseconds);
+
+		bool Write(const char* fileName) const;
+
+		// Nearest-rank percentiles. All zero for no samples.
+		static FrameTimeSummary Summarize(std::vector<float> milliseconds);
+
+	private:
+		std::vector<std::pair<std::string, std::string>> stringInfo;
+		std::vector<std::pair<std::string, float>> numberInfo;
+		std::vector<std::pair<std::string, FrameTimeSummary>> series;
+	};
+}
+
+#endif // _CE_FRAME_TIME_REPORT_H_
@@ -0,0 +1,64 @@
+#include "Frustum.h"
+
+namespace CE
+{
+	// Reference: Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from
+	// the World-View-Projection Matrix".
+	Frustum::Frustum(const glm::mat4& projectionView)
+	{
+		// glm is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i]).
+		const glm::vec4 row0(projectionView[0][0], projectionView[1][0], projectionView[2][0], projectionView[3][0]);
+		const glm::vec4 row1(projectionView[0][1], projectionView[1][1], projectionView[2][1], projectionView[3][1]);
+		const glm::vec4 row2(projectionView[0][2], projectionView[1][2], projectionView[2][2], projectionView[3][2]);
+		const glm::vec4 row3(projectionView[0][3], projectionView[1][3], projectionView[2][3], projectionView[3][3]);
+
+		planes[0] = row3 + row0; // left
+		planes[1] = row3 - row0; // right
+		planes[2] = row3 + row1; // bottom
+		planes[3] = row3 - row1; // top
+		planes[4] = row3 + row2; // near
+		planes[5] = row3 - row2; // far
+
+		for (glm::vec4& plane : planes)
+		{
+			plane /= glm::length(glm::vec3(plane));
+		}
+	}
+
+	bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Frustum::IntersectsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model) const
+	{
+		// Transform the center and the half extents, which gives the world-space
+		// box around the transformed box, then project it onto each plane normal.
+		const glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.f));
+		const glm::vec3 localExtent = (boundsMax - boundsMin) * 0.5f;
+		const glm::vec3 extent =
+			glm::abs(glm::vec3(model[0])) * localExtent.x
+			+ glm::abs(glm::vec3(model[1])) * localExtent.y
+			+ glm::abs(glm::vec3(model[2])) * localExtent.z;
+
+		for (const glm::vec4& plane : planes)
+		{
+			const glm::vec3 normal(plane);
+			const float radius = glm::dot(glm::abs(normal), extent);
+			if (glm::dot(normal, center) + plane.w < -radius)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
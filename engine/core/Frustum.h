@@ -0,0 +1,26 @@
+#ifndef _CE_FRUSTUM_H_
+#define _CE_FRUSTUM_H_
+
+#include <glm/glm.hpp>
+
+namespace CE
+{
+	class Frustum
+	{
+	public:
+		// Extracts the six clip planes from a combined projection * view matrix.
+		Frustum(const glm::mat4& projectionView);
+
+		bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+		// Tests the box from boundsMin to boundsMax, placed in the world by model.
+		// Conservative: boxes near the frustum's corners may pass without being visible.
+		bool IntersectsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model) const;
+
+	private:
+		// Normalized planes with the normal in xyz pointing inside, and distance in w.
+		glm::vec4 planes[6];
+	};
+}
+
+#endif // _CE_FRUSTUM_H_
@@ -0,0 +1,45 @@
+#include "GpuTimeCounter.h"
+
+#include "event/core/EventSystem.h"
+#include "clock/RealTimeClock.h"
+#include "graphics/render/GpuPassTimer.h"
+
+namespace CE
+{
+	static const float SMOOTHING_WEIGHT = 0.1f;
+
+	static void Smooth(float& smoothed, float milliseconds)
+	{
+		smoothed = (milliseconds * SMOOTHING_WEIGHT) + (smoothed * (1.f - SMOOTHING_WEIGHT));
+	}
+
+	GpuTimeCounter::GpuTimeCounter(EventSystem* eventSystem)
+		: eventSystem(eventSystem)
+	{
+		state.meshMilliseconds = 0.f;
+		state.skeletonMilliseconds = 0.f;
+		state.gridMilliseconds = 0.f;
+		state.uiMilliseconds = 0.f;
+		state.totalMilliseconds = 0.f;
+	}
+
+	void GpuTimeCounter::Update(const GpuPassTimes& times)
+	{
+		Smooth(state.meshMilliseconds, times.passMilliseconds[static_cast<unsigned>(GpuPass::MESHES)]);
+		Smooth(state.skeletonMilliseconds, times.passMilliseconds[static_cast<unsigned>(GpuPass::SKELETONS)]);
+		Smooth(state.gridMilliseconds, times.passMilliseconds[static_cast<unsigned>(GpuPass::GRID)]);
+		Smooth(
+			state.uiMilliseconds,
+			times.passMilliseconds[static_cast<unsigned>(GpuPass::UI_OPAQUE)] + times.passMilliseconds[static_cast<unsigned>(GpuPass::UI)]);
+		Smooth(state.totalMilliseconds, times.totalMilliseconds);
+		SendGpuTimesStateEvent();
+	}
+
+	void GpuTimeCounter::SendGpuTimesStateEvent()
+	{
+		uint64_t throttleTicks = RealTimeClock::Get().GetNextTicksForInterval(1.f / 30.f);
+
+		GpuTimesStateEvent event = state;
+		eventSystem->EnqueueEventThrottled(event, throttleTicks);
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef _CE_GPU_TIME_COUNTER_H_
+#define _CE_GPU_TIME_COUNTER_H_
+
+#include "event/GpuTimesStateEvent.h"
+
+class EventSystem;
+
+namespace CE
+{
+	struct GpuPassTimes;
+
+	// Smooths the GPU pass times the render thread measures, and publishes
+	// them as a GpuTimesStateEvent.
+	class GpuTimeCounter
+	{
+	public:
+		GpuTimeCounter(EventSystem* eventSystem);
+
+		void Update(const GpuPassTimes& times);
+
+	private:
+		void SendGpuTimesStateEvent();
+
+		EventSystem* eventSystem;
+		GpuTimesStateEvent state;
+	};
+}
+
+#endif // _CE_GPU_TIME_COUNTER_H_
@@ -0,0 +1,44 @@
+#include "GpuTimesStateEvent.h"
+
+#include "common/json/JsonSerializer.h"
+#include "common/json/JsonDeserializer.h"
+
+GpuTimesStateEvent::GpuTimesStateEvent()
+	: Event(EventType::GPU_TIMES_STATE)
+{
+
+}
+
+GpuTimesStateEvent* GpuTimesStateEvent::Clone() const
+{
+	return new GpuTimesStateEvent(*this);
+}
+
+void GpuTimesStateEvent::SerializeInternal(JsonSerializer& serializer) const
+{
+	serializer.WriteFloat("meshMilliseconds", meshMilliseconds);
+	serializer.WriteFloat("skeletonMilliseconds", skeletonMilliseconds);
+	serializer.WriteFloat("gridMilliseconds", gridMilliseconds);
+	serializer.WriteFloat("uiMilliseconds", uiMilliseconds);
+	serializer.WriteFloat("totalMilliseconds", totalMilliseconds);
+}
+
+void GpuTimesStateEvent::DeserializeInternal(const JsonDeserializer& deserializer)
+{
+	meshMilliseconds = deserializer.GetFloat("meshMilliseconds");
+	skeletonMilliseconds = deserializer.GetFloat("skeletonMilliseconds");
+	gridMilliseconds = deserializer.GetFloat("gridMilliseconds");
+	uiMilliseconds = deserializer.GetFloat("uiMilliseconds");
+	totalMilliseconds = deserializer.GetFloat("totalMilliseconds");
+}
+
+RequestGpuTimesStateEvent::RequestGpuTimesStateEvent()
+	: Event(EventType::REQUEST_GPU_TIMES_STATE)
+{
+
+}
+
+RequestGpuTimesStateEvent* RequestGpuTimesStateEvent::Clone() const
+{
+	return new RequestGpuTimesStateEvent(*this);
+}
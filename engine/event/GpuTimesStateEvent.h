@@ -0,0 +1,29 @@
+#ifndef _CE_GPU_TIMES_STATE_EVENT_H_
+#define _CE_GPU_TIMES_STATE_EVENT_H_
+
+#include "core/Event.h"
+
+// Smoothed GPU time of each pass of a frame, in milliseconds.
+struct GpuTimesStateEvent : Event
+{
+	GpuTimesStateEvent();
+	GpuTimesStateEvent* Clone() const override;
+
+	float meshMilliseconds;
+	float skeletonMilliseconds;
+	float gridMilliseconds;
+	float uiMilliseconds;
+	float totalMilliseconds;
+
+protected:
+	void SerializeInternal(JsonSerializer& serializer) const override;
+	void DeserializeInternal(const JsonDeserializer& deserializer) override;
+};
+
+struct RequestGpuTimesStateEvent : Event
+{
+	RequestGpuTimesStateEvent();
+	RequestGpuTimesStateEvent* Clone() const override;
+};
+
+#endif // _CE_GPU_TIMES_STATE_EVENT_H_
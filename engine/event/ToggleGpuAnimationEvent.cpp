@@ -0,0 +1,12 @@
+#include "ToggleGpuAnimationEvent.h"
+
+ToggleGpuAnimationEvent::ToggleGpuAnimationEvent()
+	: Event(EventType::TOGGLE_GPU_ANIMATION)
+{
+
+}
+
+ToggleGpuAnimationEvent* ToggleGpuAnimationEvent::Clone() const
+{
+	return new ToggleGpuAnimationEvent(*this);
+}
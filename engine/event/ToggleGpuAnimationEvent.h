@@ -0,0 +1,12 @@
+#ifndef _CE_TOGGLE_GPU_ANIMATION_EVENT_H_
+#define _CE_TOGGLE_GPU_ANIMATION_EVENT_H_
+
+#include "core/Event.h"
+
+struct ToggleGpuAnimationEvent : Event
+{
+	ToggleGpuAnimationEvent();
+	ToggleGpuAnimationEvent* Clone() const override;
+};
+
+#endif // _CE_TOGGLE_GPU_ANIMATION_EVENT_H_
@@ -0,0 +1,12 @@
+#include "ToggleInstancingEvent.h"
+
+ToggleInstancingEvent::ToggleInstancingEvent()
+	: Event(EventType::TOGGLE_INSTANCING)
+{
+
+}
+
+ToggleInstancingEvent* ToggleInstancingEvent::Clone() const
+{
+	return new ToggleInstancingEvent(*this);
+}
@@ -0,0 +1,12 @@
+#ifndef _CE_TOGGLE_INSTANCING_EVENT_H_
+#define _CE_TOGGLE_INSTANCING_EVENT_H_
+
+#include "core/Event.h"
+
+struct ToggleInstancingEvent : Event
+{
+	ToggleInstancingEvent();
+	ToggleInstancingEvent* Clone() const override;
+};
+
+#endif // _CE_TOGGLE_INSTANCING_EVENT_H_
@@ -16,7 +16,11 @@ enum class EventType : uint32_t
 	FPS_STATE,
 	TOGGLE_BIND_POSE,
 	SDL,
-	WINDOWS_MESSAGE
+	WINDOWS_MESSAGE,
+	TOGGLE_GPU_ANIMATION,
+	TOGGLE_INSTANCING,
+	REQUEST_GPU_TIMES_STATE,
+	GPU_TIMES_STATE
 };
 
 #endif // _CE_EVENT_TYPE_H_
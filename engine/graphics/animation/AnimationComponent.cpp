@@ -2,6 +2,8 @@
 
 #include "Animation.h"
 #include "graphics/skeleton/Skeleton.h"
+#include "graphics/buffer/StreamingBuffer.h"
+#include "graphics/render/GLStateCache.h"
 
 #include "event/core/EventSystem.h"
 #include "common/Math.h"
@@ -9,6 +11,7 @@
 #include <GL/glew.h>
 
 #include <algorithm>
+#include <cstdio>
 
 namespace CE
 {
@@ -20,9 +23,19 @@ namespace CE
 		, m_skeleton(skeleton)
 		, m_animations(animations)
 		, m_currentAnimation(0)
+		, m_poseDirty(true)
+		, m_lod(0)
+		, m_lodLevel({ 0.f, 1, false })
+		, m_framesSinceEvaluation(0)
+		, m_rootPosition(0.f)
+		, m_lastPaletteTime(0.f)
+		, m_previousPaletteTime(0.f)
+		, m_paletteHistoryCount(0)
 	{
 		InitializeAnimationCache();
 		InitializePalette();
+		InitializeLod();
+		UpdateRootPosition();
 	}
 
 	void AnimationComponent::InitializeAnimationCache()
@@ -48,6 +61,33 @@ namespace CE
 		{
 			m_palette.push_back(glm::mat4());
 		}
+
+		m_bindPosePalette.resize(m_skeleton->joints.size(), glm::mat4(1.f));
+	}
+
+	void AnimationComponent::InitializeLod()
+	{
+		m_reducedJointMask = AnimationLodPolicy::BuildReducedJointMask(*m_skeleton);
+
+		// Joints skipped at reduced LODs keep their bind pose relative to their parent.
+		m_bindLocalPoses.reserve(m_skeleton->joints.size());
+		for (size_t i = 0; i < m_skeleton->joints.size(); ++i)
+		{
+			const Joint& joint = m_skeleton->joints[i];
+			const glm::mat4 bindPose = glm::inverse(joint.inverseBindPose);
+
+			if (joint.parentIndex == -1)
+			{
+				m_bindLocalPoses.push_back(bindPose);
+			}
+			else
+			{
+				m_bindLocalPoses.push_back(m_skeleton->joints[joint.parentIndex].inverseBindPose * bindPose);
+			}
+		}
+
+		m_lastPalette = m_palette;
+		m_previousPalette = m_palette;
 	}
 
 	void AnimationComponent::FindInterpolationKeys(size_t currentJoint)
@@ -136,7 +176,8 @@ namespace CE
 
 	void AnimationComponent::Update(float deltaSeconds)
 	{
-		if (m_animations->empty())
+		// Paused clocks report a zero delta; nothing changes, so the pose stays valid.
+		if (m_animations->empty() || deltaSeconds == 0.f)
 		{
 			return;
 		}
@@ -154,39 +195,86 @@ namespace CE
 			// use this to loop all animations
 			animationCache->currTime = 0;
 			m_currentAnimation = ++m_currentAnimation % m_animations->size();
-			animation = &m_animations->at(m_currentAnimation);
-			animationCache = &m_animationCaches[m_currentAnimation];
+
+			// Extrapolating across a clip change would blend two unrelated poses.
+			ResetPaletteHistory();
 		}
 
+		++m_framesSinceEvaluation;
+		m_poseDirty = true;
+
+		UpdateRootPosition();
+
+		animationEventHandler.SendAnimationStateEvent();
+	}
+
+	void AnimationComponent::EvaluatePose()
+	{
+		if (!m_poseDirty || m_animations->empty())
+		{
+			return;
+		}
+
+		if (m_framesSinceEvaluation >= m_lodLevel.updateInterval || m_paletteHistoryCount < 2)
+		{
+			EvaluatePalette();
+		}
+		else
+		{
+			ExtrapolatePalette();
+		}
+
+		m_poseDirty = false;
+	}
+
+	void AnimationComponent::SetLod(unsigned lod, const AnimationLodLevel& lodLevel)
+	{
+		m_lod = lod;
+		m_lodLevel = lodLevel;
+	}
+
+	glm::mat4 AnimationComponent::SampleLocalPose(size_t currentJoint)
+	{
+		const Animation* animation = &m_animations->at(m_currentAnimation);
+		const AnimationCache* animationCache = &m_animationCaches[m_currentAnimation];
+		const size_t i = currentJoint;
+
+		FindInterpolationKeys(i);
+
+		const TranslationKey& lowTranslationKey = animation->translations[i][animationCache->currTranslations[i]];
+		const TranslationKey& highTranslationKey = animation->translations[i][std::min(animationCache->currTranslations[i] + 1, (int)animation->translations[i].size() - 1)];
+		const float translationAlpha = (animationCache->currTime - lowTranslationKey.time) / (highTranslationKey.time - lowTranslationKey.time);
+		const glm::vec3 translation = LerpTranslation(
+			lowTranslationKey.translation,
+			highTranslationKey.translation,
+			highTranslationKey.time == lowTranslationKey.time ? 0.f : translationAlpha);
+
+		const RotationKey& lowRotationKey = animation->rotations[i][animationCache->currRotations[i]];
+		const RotationKey& highRotationKey = animation->rotations[i][std::min(animationCache->currRotations[i] + 1, (int)animation->rotations[i].size() - 1)];
+		const float rotationAlpha = (animationCache->currTime - lowRotationKey.time) / (highRotationKey.time - lowRotationKey.time);
+		const glm::quat rotation = LerpRotation(
+			lowRotationKey.rotation,
+			highRotationKey.rotation,
+			highRotationKey.time == lowRotationKey.time ? 0.f : rotationAlpha);
+
+		const ScaleKey& lowScaleKey = animation->scales[i][animationCache->currScales[i]];
+		const ScaleKey& highScaleKey = animation->scales[i][std::min(animationCache->currScales[i] + 1, (int)animation->scales[i].size() - 1)];
+		const float scaleAlpha = (animationCache->currTime - lowScaleKey.time) / (highScaleKey.time - lowScaleKey.time);
+		const glm::vec3 scale = LerpScale(
+			lowScaleKey.scale,
+			highScaleKey.scale,
+			highScaleKey.time == lowScaleKey.time ? 0.f : scaleAlpha);
+
+		return ToAffineMatrix(translation, rotation, scale);
+	}
+
+	void AnimationComponent::EvaluatePalette()
+	{
 		for (size_t i = 0; i < m_skeleton->joints.size(); ++i)
 		{
-			FindInterpolationKeys(i);
-
-			const TranslationKey& lowTranslationKey = animation->translations[i][animationCache->currTranslations[i]];
-			const TranslationKey& highTranslationKey = animation->translations[i][std::min(animationCache->currTranslations[i] + 1, (int)animation->translations[i].size() - 1)];
-			const float translationAlpha = (animationCache->currTime - lowTranslationKey.time) / (highTranslationKey.time - lowTranslationKey.time);
-			const glm::vec3 translation = LerpTranslation(
-				lowTranslationKey.translation,
-				highTranslationKey.translation,
-				highTranslationKey.time == lowTranslationKey.time ? 0.f : translationAlpha);
-
-			const RotationKey& lowRotationKey = animation->rotations[i][animationCache->currRotations[i]];
-			const RotationKey& highRotationKey = animation->rotations[i][std::min(animationCache->currRotations[i] + 1, (int)animation->rotations[i].size() - 1)];
-			const float rotationAlpha = (animationCache->currTime - lowRotationKey.time) / (highRotationKey.time - lowRotationKey.time);
-			const glm::quat rotation = LerpRotation(
-				lowRotationKey.rotation,
-				highRotationKey.rotation,
-				highRotationKey.time == lowRotationKey.time ? 0.f : rotationAlpha);
-
-			const ScaleKey& lowScaleKey = animation->scales[i][animationCache->currScales[i]];
-			const ScaleKey& highScaleKey = animation->scales[i][std::min(animationCache->currScales[i] + 1, (int)animation->scales[i].size() - 1)];
-			const float scaleAlpha = (animationCache->currTime - lowScaleKey.time) / (highScaleKey.time - lowScaleKey.time);
-			const glm::vec3 scale = LerpScale(
-				lowScaleKey.scale,
-				highScaleKey.scale,
-				highScaleKey.time == lowScaleKey.time ? 0.f : scaleAlpha);
-
-			glm::mat4 localPose = ToAffineMatrix(translation, rotation, scale);
+			glm::mat4 localPose = m_lodLevel.reducedJoints && !m_reducedJointMask[i]
+				? m_bindLocalPoses[i]
+				: SampleLocalPose(i);
 
 			if (m_skeleton->joints[i].parentIndex == -1)
 			{
@@ -203,33 +291,105 @@ namespace CE
 			m_palette[i] = m_palette[i] * m_skeleton->joints[i].inverseBindPose;
 		}
 
-		animationEventHandler.SendAnimationStateEvent();
+		std::swap(m_previousPalette, m_lastPalette);
+		m_lastPalette = m_palette;
+		m_previousPaletteTime = m_lastPaletteTime;
+		m_lastPaletteTime = m_animationCaches[m_currentAnimation].currTime;
+		m_paletteHistoryCount = std::min(m_paletteHistoryCount + 1, 2u);
+		m_framesSinceEvaluation = 0;
+	}
+
+	void AnimationComponent::ExtrapolatePalette()
+	{
+		// Linear extrapolation of the skinning matrices from the last two evaluations.
+		// This is not a rigid transform, but the error is small over 1-3 frames and
+		// far cheaper than sampling every joint.
+		const float currentTime = m_animationCaches[m_currentAnimation].currTime;
+		const float interval = m_lastPaletteTime - m_previousPaletteTime;
+		const float alpha = interval > 0.f ? (currentTime - m_lastPaletteTime) / interval : 0.f;
+
+		for (size_t i = 0; i < m_palette.size(); ++i)
+		{
+			m_palette[i] = m_lastPalette[i] + (m_lastPalette[i] - m_previousPalette[i]) * alpha;
+		}
+	}
+
+	void AnimationComponent::ResetPaletteHistory()
+	{
+		m_paletteHistoryCount = 0;
+	}
+
+	void AnimationComponent::InvalidatePose()
+	{
+		ResetPaletteHistory();
+		m_poseDirty = true;
+		UpdateRootPosition();
+	}
+
+	void AnimationComponent::UpdateRootPosition()
+	{
+		// Only the root is sampled so that LOD selection and culling have a
+		// position even for characters whose full pose is never requested.
+		if (m_animations->empty() || m_skeleton->joints.empty() || m_skeleton->joints[0].parentIndex != -1)
+		{
+			return;
+		}
+
+		m_rootPosition = glm::vec3(SampleLocalPose(0)[3]);
+	}
+
+	const std::vector<glm::mat4>& AnimationComponent::GetMatrixPalette(bool bindPose)
+	{
+		// The bind pose needs no evaluation at all.
+		if (bindPose)
+		{
+			return m_bindPosePalette;
+		}
+
+		EvaluatePose();
+		return m_palette;
 	}
 
 	void AnimationComponent::BindMatrixPalette(
+		const glm::mat4* palette,
+		size_t jointCount,
 		GLuint g_paletteTextureUnit,
 		GLuint g_paletteGenTex,
 		GLuint g_tbo,
-		GLuint g_paletteID)
+		GLuint g_paletteID,
+		StreamingBuffer& streamingBuffer)
 	{
-		if (m_palette.empty())
+		if (jointCount == 0)
 		{
 			return;
 		}
 
-		glActiveTexture(GL_TEXTURE0 + g_paletteTextureUnit);
-		glBindTexture(GL_TEXTURE_BUFFER, g_paletteGenTex);
-		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, g_tbo);
-		glBindBuffer(GL_TEXTURE_BUFFER, g_tbo);
-		glBufferData(GL_TEXTURE_BUFFER, m_palette.size() * sizeof(glm::mat4), m_palette.data(), GL_DYNAMIC_DRAW);
-		glUniform1i(g_paletteID, g_paletteTextureUnit);
-	}
+		StreamingAllocation allocation = streamingBuffer.Allocate(palette, jointCount * sizeof(glm::mat4), streamingBuffer.GetTextureBufferAlignment());
+		if (!allocation.IsValid())
+		{
+			return;
+		}
 
-	void AnimationComponent::ResetMatrixPalette()
-	{
-		for (size_t i = 0; i < m_skeleton->joints.size(); ++i)
+		GLStateCache& stateCache = GLStateCache::Get();
+		stateCache.BindTexture(g_paletteTextureUnit, GL_TEXTURE_BUFFER, g_paletteGenTex);
+
+		if (GLEW_ARB_texture_buffer_range)
 		{
-			m_palette[i] = glm::mat4(1.f);
+			stateCache.TexBufferRange(GL_RGBA32F, allocation.buffer, allocation.offset, allocation.size);
 		}
+		else if (jointCount <= MAX_PALETTE_JOINTS)
+		{
+			// A GPU-side copy; the CPU never waits on g_tbo.
+			stateCache.BindBuffer(GL_COPY_READ_BUFFER, allocation.buffer);
+			stateCache.BindBuffer(GL_COPY_WRITE_BUFFER, g_tbo);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation.offset, 0, allocation.size);
+			stateCache.TexBufferRange(GL_RGBA32F, g_tbo, 0, 0);
+		}
+		else
+		{
+			printf("palette of %zu joints exceeds MAX_PALETTE_JOINTS\n", jointCount);
+		}
+
+		stateCache.Uniform1i(g_paletteID, g_paletteTextureUnit);
 	}
 }
@@ -3,6 +3,7 @@
 
 #include "Animation.h"
 #include "AnimationEventHandler.h"
+#include "AnimationLod.h"
 
 #include <glm/glm.hpp>
 
@@ -14,6 +15,12 @@ typedef unsigned int GLuint;
 namespace CE
 {
 	struct Skeleton;
+	class StreamingBuffer;
+
+	// Capacity of the fallback palette buffer used without ARB_texture_buffer_range.
+	// Instanced draws bind every visible character's palette at once, so this is
+	// sized to the smallest GL_MAX_TEXTURE_BUFFER_SIZE of 65536 texels.
+	const unsigned MAX_PALETTE_JOINTS = 16384;
 
 	struct AnimationCache
 	{
@@ -26,27 +33,54 @@ namespace CE
 	class AnimationComponent
 	{
 	public:
+		// eventSystem is null for all but the one character the UI shows and
+		// controls, so a crowd sends one animation state rather than one each.
 		AnimationComponent(
 			Skeleton* skeleton,
 			Animations* animations,
 			EventSystem* eventSystem);
 
 		void Update(float deltaSeconds);
-		void BindMatrixPalette(
+		void SetLod(unsigned lod, const AnimationLodLevel& lodLevel);
+
+		// Evaluates the pose if time or clip changed since the last evaluation.
+		// Called lazily by whoever needs the palette this frame.
+		void EvaluatePose();
+
+		// Evaluates the pose if needed. Only the simulation calls this; the
+		// render thread binds a copy of the palette from its render packet.
+		const std::vector<glm::mat4>& GetMatrixPalette(bool bindPose);
+
+		// Streams jointCount matrices through streamingBuffer. g_tbo is only used as
+		// a copy target when texture buffers cannot view a range of another buffer.
+		static void BindMatrixPalette(
+			const glm::mat4* palette,
+			size_t jointCount,
 			GLuint g_paletteTextureUnit,
 			GLuint g_paletteGenTex,
 			GLuint g_tbo,
-			GLuint g_paletteID);
-
-		void ResetMatrixPalette();
+			GLuint g_paletteID,
+			StreamingBuffer& streamingBuffer);
 
 		// TODO: Remove.
 		const Skeleton* GetSkeleton() const { return m_skeleton; }
 
+		unsigned GetLod() const { return m_lod; }
+		int GetCurrentAnimation() const { return m_currentAnimation; }
+		float GetCurrentTime() const { return m_animationCaches.empty() ? 0.f : m_animationCaches[m_currentAnimation].currTime; }
+		const glm::vec3& GetRootPosition() const { return m_rootPosition; }
+
 	private:
 		void InitializeAnimationCache();
 		void InitializePalette();
+		void InitializeLod();
 		void FindInterpolationKeys(size_t currentJoint);
+		glm::mat4 SampleLocalPose(size_t currentJoint);
+		void EvaluatePalette();
+		void ExtrapolatePalette();
+		void ResetPaletteHistory();
+		void InvalidatePose();
+		void UpdateRootPosition();
 
 		AnimationEventHandler animationEventHandler;
 
@@ -54,7 +88,24 @@ namespace CE
 		Animations* m_animations;
 		std::vector<AnimationCache> m_animationCaches;
 		std::vector<glm::mat4> m_palette;
+		std::vector<glm::mat4> m_bindPosePalette;
 		int m_currentAnimation;
+		bool m_poseDirty;
+
+		// Level of detail.
+		unsigned m_lod;
+		AnimationLodLevel m_lodLevel;
+		unsigned m_framesSinceEvaluation;
+		std::vector<bool> m_reducedJointMask;
+		std::vector<glm::mat4> m_bindLocalPoses;
+		glm::vec3 m_rootPosition;
+
+		// The two most recently evaluated palettes, used for extrapolation.
+		std::vector<glm::mat4> m_lastPalette;
+		std::vector<glm::mat4> m_previousPalette;
+		float m_lastPaletteTime;
+		float m_previousPaletteTime;
+		unsigned m_paletteHistoryCount;
 
 		friend class AnimationEventHandler;
 	};
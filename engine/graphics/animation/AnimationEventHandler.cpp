@@ -15,6 +15,11 @@ namespace CE
 		: eventSystem(eventSystem)
 		, animationComponent(animationComponent)
 	{
+		if (eventSystem == nullptr)
+		{
+			return;
+		}
+
 		eventSystem->RegisterListener(this, EventType::REQUEST_ANIMATION_STATE);
 		eventSystem->RegisterListener(this, EventType::SET_ANIMATION_TIME);
 	}
@@ -39,6 +44,11 @@ namespace CE
 
 	void AnimationEventHandler::SendAnimationStateEvent()
 	{
+		if (eventSystem == nullptr)
+		{
+			return;
+		}
+
 		uint64_t throttleTicks = RealTimeClock::Get().GetNextTicksForInterval(1.f / 30.f);
 
 		Animation* animation = &animationComponent->m_animations->at(animationComponent->m_currentAnimation);
@@ -58,6 +68,7 @@ namespace CE
 		// TODO: There's definitely more to do here. I think this should also do a FindInterpolationKeys?
 		AnimationCache* animationCache = &animationComponent->m_animationCaches[animationComponent->m_currentAnimation];
 		animationCache->currTime = setAnimationTimeEvent.time;
+		animationComponent->InvalidatePose();
 
 		SendAnimationStateEvent();
 	}
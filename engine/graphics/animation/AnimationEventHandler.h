@@ -9,6 +9,8 @@ namespace CE
 {
 	class AnimationComponent;
 
+	// Without an event system, the component neither reports its state nor
+	// takes requests.
 	class AnimationEventHandler : public EventListener
 	{
 	public:
@@ -0,0 +1,75 @@
+#include "AnimationLod.h"
+
+#include "graphics/skeleton/Skeleton.h"
+
+#include <cstring>
+#include <string>
+
+namespace CE
+{
+	static bool EndsWith(const std::string& string, const char* suffix)
+	{
+		const size_t suffixLength = strlen(suffix);
+		return string.size() >= suffixLength
+			&& string.compare(string.size() - suffixLength, suffixLength, suffix) == 0;
+	}
+
+	AnimationLodPolicy::AnimationLodPolicy()
+		: enabled(true)
+	{
+		// Distances are in asset units (centimeters for Mixamo assets).
+		levels.push_back({ 0.f, 1, false });
+		levels.push_back({ 1500.f, 2, false });
+		levels.push_back({ 3000.f, 4, true });
+	}
+
+	unsigned AnimationLodPolicy::SelectLod(float cameraDistance) const
+	{
+		if (!enabled)
+		{
+			return 0;
+		}
+
+		unsigned lod = 0;
+		for (unsigned i = 1; i < levels.size(); ++i)
+		{
+			if (cameraDistance >= levels[i].minDistance)
+			{
+				lod = i;
+			}
+		}
+		return lod;
+	}
+
+	std::vector<bool> AnimationLodPolicy::BuildReducedJointMask(const Skeleton& skeleton)
+	{
+		std::vector<bool> mask(skeleton.joints.size(), true);
+
+		for (size_t i = 0; i < skeleton.joints.size(); ++i)
+		{
+			const Joint& joint = skeleton.joints[i];
+
+			// Leaf helpers (e.g. "mixamorig:HeadTop_End") never influence skinning.
+			if (EndsWith(joint.name, "_End"))
+			{
+				mask[i] = false;
+				continue;
+			}
+
+			if (joint.parentIndex == -1)
+			{
+				continue;
+			}
+
+			// Everything below a hand is a finger. Joints are stored parent-first,
+			// so the parent's mask is already final.
+			const Joint& parent = skeleton.joints[joint.parentIndex];
+			if (EndsWith(parent.name, "Hand") || !mask[joint.parentIndex])
+			{
+				mask[i] = false;
+			}
+		}
+
+		return mask;
+	}
+}
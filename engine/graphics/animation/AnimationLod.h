@@ -0,0 +1,44 @@
+#ifndef _CE_ANIMATION_LOD_H_
+#define _CE_ANIMATION_LOD_H_
+
+#include <vector>
+
+namespace CE
+{
+	struct Skeleton;
+
+	struct AnimationLodLevel
+	{
+		// Camera distance at which this level starts to apply.
+		float minDistance;
+
+		// Number of frames between full pose evaluations. Frames in between
+		// extrapolate from the two most recent evaluations.
+		unsigned updateInterval;
+
+		// Whether to skip joints that are not in the reduced joint set.
+		bool reducedJoints;
+	};
+
+	class AnimationLodPolicy
+	{
+	public:
+		AnimationLodPolicy();
+
+		unsigned SelectLod(float cameraDistance) const;
+		const AnimationLodLevel& GetLevel(unsigned lod) const { return levels[lod]; }
+
+		void SetEnabled(bool enabled) { this->enabled = enabled; }
+		bool IsEnabled() const { return enabled; }
+
+		// Joints excluded from the reduced set (e.g. fingers) are not sampled at
+		// reduced LODs, and instead keep their bind pose relative to their parent.
+		static std::vector<bool> BuildReducedJointMask(const Skeleton& skeleton);
+
+	private:
+		std::vector<AnimationLodLevel> levels;
+		bool enabled;
+	};
+}
+
+#endif // _CE_ANIMATION_LOD_H_
@@ -0,0 +1,109 @@
+#include "AnimationTexture.h"
+
+#include "graphics/skeleton/Skeleton.h"
+#include "graphics/render/GLStateCache.h"
+#include "common/Math.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CE
+{
+	AnimationTexture::AnimationTexture(const Skeleton& skeleton, const Animations& animations, float sampleRate)
+		: m_jointCount(static_cast<unsigned>(skeleton.joints.size()))
+		, m_frameCount(0)
+		, m_sampleRate(sampleRate)
+		, m_textureId(0)
+	{
+		std::vector<glm::mat4> frames;
+
+		for (const Animation& animation : animations)
+		{
+			AnimationTextureClip clip;
+			clip.firstFrame = m_frameCount;
+			clip.frameCount = static_cast<unsigned>(std::ceil(animation.duration * m_sampleRate)) + 1;
+			m_clips.push_back(clip);
+
+			BakeClip(skeleton, animation, frames);
+			m_frameCount += clip.frameCount;
+		}
+
+		Upload(frames);
+	}
+
+	AnimationTexture::~AnimationTexture()
+	{
+		GLStateCache::Get().DeleteTextures(1, &m_textureId);
+	}
+
+	void AnimationTexture::BakeClip(const Skeleton& skeleton, const Animation& animation, std::vector<glm::mat4>& outFrames)
+	{
+		const unsigned frameCount = static_cast<unsigned>(std::ceil(animation.duration * m_sampleRate)) + 1;
+		std::vector<glm::mat4> modelPoses(m_jointCount);
+
+		for (unsigned frame = 0; frame < frameCount; ++frame)
+		{
+			const float time = std::min(frame / m_sampleRate, animation.duration);
+
+			for (unsigned i = 0; i < m_jointCount; ++i)
+			{
+				const glm::vec3 translation = SampleKeys(animation.translations[i], time, &TranslationKey::translation, LerpTranslation);
+				const glm::quat rotation = SampleKeys(animation.rotations[i], time, &RotationKey::rotation, LerpRotation);
+				const glm::vec3 scale = SampleKeys(animation.scales[i], time, &ScaleKey::scale, LerpScale);
+
+				const glm::mat4 localPose = ToAffineMatrix(translation, rotation, scale);
+				const short parentIndex = skeleton.joints[i].parentIndex;
+				modelPoses[i] = parentIndex == -1 ? localPose : modelPoses[parentIndex] * localPose;
+			}
+
+			for (unsigned i = 0; i < m_jointCount; ++i)
+			{
+				outFrames.push_back(modelPoses[i] * skeleton.joints[i].inverseBindPose);
+			}
+		}
+	}
+
+	void AnimationTexture::Upload(const std::vector<glm::mat4>& frames)
+	{
+		// The baked frames only live on the GPU.
+		GLStateCache& stateCache = GLStateCache::Get();
+		glGenTextures(1, &m_textureId);
+		stateCache.BindTexture(0, GL_TEXTURE_2D, m_textureId);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(
+			GL_TEXTURE_2D,
+			0,
+			GL_RGBA32F,
+			m_jointCount * 4,
+			m_frameCount,
+			0,
+			GL_RGBA,
+			GL_FLOAT,
+			frames.empty() ? nullptr : frames.data());
+	}
+
+	void AnimationTexture::Bind(GLuint textureUnit, GLuint textureLocation) const
+	{
+		GLStateCache::Get().BindTexture(textureUnit, GL_TEXTURE_2D, m_textureId);
+		GLStateCache::Get().Uniform1i(textureLocation, textureUnit);
+	}
+
+	glm::vec4 AnimationTexture::CreateInstanceAttribute(unsigned clip, float time) const
+	{
+		if (clip >= m_clips.size())
+		{
+			return glm::vec4(0.f, 1.f, 0.f, m_sampleRate);
+		}
+
+		return glm::vec4(
+			static_cast<float>(m_clips[clip].firstFrame),
+			static_cast<float>(m_clips[clip].frameCount),
+			time,
+			m_sampleRate);
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef _CE_ANIMATION_TEXTURE_H_
+#define _CE_ANIMATION_TEXTURE_H_
+
+#include "Animation.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+typedef unsigned int GLuint;
+
+namespace CE
+{
+	struct Skeleton;
+
+	struct AnimationTextureClip
+	{
+		unsigned firstFrame;
+		unsigned frameCount;
+	};
+
+	// Every clip resampled at a uniform rate into skinning matrices (model-space
+	// pose * inverse bind pose), stored in one RGBA32F texture that the skinning
+	// vertex shader samples directly. Each row is one frame, and each joint takes
+	// four texels (one per matrix column).
+	class AnimationTexture
+	{
+	public:
+		AnimationTexture(const Skeleton& skeleton, const Animations& animations, float sampleRate);
+		~AnimationTexture();
+		AnimationTexture(const AnimationTexture&) = delete;
+		AnimationTexture& operator=(const AnimationTexture&) = delete;
+
+		void Bind(GLuint textureUnit, GLuint textureLocation) const;
+
+		// Matches the animationInstance attribute in SkinnedMeshGpuAnimationShader.vert.
+		glm::vec4 CreateInstanceAttribute(unsigned clip, float time) const;
+
+	private:
+		void BakeClip(const Skeleton& skeleton, const Animation& animation, std::vector<glm::mat4>& outFrames);
+		void Upload(const std::vector<glm::mat4>& frames);
+
+		std::vector<AnimationTextureClip> m_clips;
+		unsigned m_jointCount;
+		unsigned m_frameCount;
+		float m_sampleRate;
+		GLuint m_textureId;
+	};
+}
+
+#endif // _CE_ANIMATION_TEXTURE_H_
@@ -0,0 +1,19 @@
+#include "BufferStorage.h"
+
+#include <GL/glew.h>
+
+namespace CE
+{
+	void AllocateStaticBufferStorage(GLenum target, size_t size, const void* data)
+	{
+		// Core only in 4.4, and macOS stops at 4.1.
+		if (GLEW_ARB_buffer_storage)
+		{
+			glBufferStorage(target, size, data, 0);
+		}
+		else
+		{
+			glBufferData(target, size, data, GL_STATIC_DRAW);
+		}
+	}
+}
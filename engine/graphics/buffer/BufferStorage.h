@@ -0,0 +1,16 @@
+#ifndef _CE_BUFFER_STORAGE_H_
+#define _CE_BUFFER_STORAGE_H_
+
+#include <cstddef>
+
+typedef unsigned int GLenum;
+
+namespace CE
+{
+	// Allocates the store of the buffer bound to target, filled with data, for
+	// contents that never change after load. The store is immutable where
+	// ARB_buffer_storage is available, and a GL_STATIC_DRAW store otherwise.
+	void AllocateStaticBufferStorage(GLenum target, size_t size, const void* data);
+}
+
+#endif // _CE_BUFFER_STORAGE_H_
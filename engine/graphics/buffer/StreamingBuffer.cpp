@@ -0,0 +1,150 @@
+#include "StreamingBuffer.h"
+
+#include "graphics/render/GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace CE
+{
+	StreamingBuffer::StreamingBuffer(size_t frameSize)
+		: m_buffer(0)
+		, m_mappedData(nullptr)
+		, m_frameSize(frameSize)
+		, m_frameOffset(0)
+		, m_frame(0)
+		, m_textureBufferAlignment(DEFAULT_ALIGNMENT)
+	{
+		for (unsigned i = 0; i < FRAME_COUNT; ++i)
+		{
+			m_fences[i] = nullptr;
+		}
+
+		const size_t bufferSize = m_frameSize * FRAME_COUNT;
+
+		// GL_COPY_WRITE_BUFFER, so that no binding used for drawing is disturbed.
+		glGenBuffers(1, &m_buffer);
+		GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+
+		if (GLEW_ARB_buffer_storage)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, flags);
+			m_mappedData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bufferSize, flags));
+		}
+		else
+		{
+			glBufferData(GL_COPY_WRITE_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+		}
+
+		if (GLEW_ARB_texture_buffer_range)
+		{
+			GLint alignment = 0;
+			glGetIntegerv(GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			if (alignment > 0)
+			{
+				m_textureBufferAlignment = alignment;
+			}
+		}
+	}
+
+	StreamingBuffer::~StreamingBuffer()
+	{
+		for (unsigned i = 0; i < FRAME_COUNT; ++i)
+		{
+			glDeleteSync(m_fences[i]);
+		}
+
+		if (m_mappedData != nullptr)
+		{
+			GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		}
+
+		GLStateCache::Get().DeleteBuffers(1, &m_buffer);
+	}
+
+	void StreamingBuffer::BeginFrame()
+	{
+		GLsync fence = m_fences[m_frame];
+		if (fence != nullptr)
+		{
+			// The region was last written FRAME_COUNT frames ago, so this rarely blocks.
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			while (result == GL_TIMEOUT_EXPIRED)
+			{
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+
+			glDeleteSync(fence);
+			m_fences[m_frame] = nullptr;
+		}
+
+		m_frameOffset = 0;
+	}
+
+	void StreamingBuffer::EndFrame()
+	{
+		m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_frame = (m_frame + 1) % FRAME_COUNT;
+	}
+
+	StreamingAllocation StreamingBuffer::Allocate(const void* data, size_t size, size_t alignment)
+	{
+		void* mappedData = nullptr;
+		StreamingAllocation allocation = Map(size, &mappedData, alignment);
+		if (allocation.IsValid())
+		{
+			memcpy(mappedData, data, size);
+			Unmap();
+		}
+
+		return allocation;
+	}
+
+	StreamingAllocation StreamingBuffer::Map(size_t size, void** data, size_t alignment)
+	{
+		StreamingAllocation allocation = { 0, 0, 0 };
+		*data = nullptr;
+
+		const size_t alignedOffset = (m_frameOffset + alignment - 1) / alignment * alignment;
+		if (alignedOffset + size > m_frameSize)
+		{
+			printf("StreamingBuffer: %zu bytes do not fit in the %zu byte frame region\n", size, m_frameSize);
+			return allocation;
+		}
+
+		allocation.buffer = m_buffer;
+		allocation.offset = m_frame * m_frameSize + alignedOffset;
+		allocation.size = size;
+		m_frameOffset = alignedOffset + size;
+
+		if (m_mappedData != nullptr)
+		{
+			*data = m_mappedData + allocation.offset;
+		}
+		else
+		{
+			// The fences already guarantee the GPU is not reading this range.
+			GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+			*data = glMapBufferRange(
+				GL_COPY_WRITE_BUFFER,
+				allocation.offset,
+				size,
+				GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+		}
+
+		return allocation;
+	}
+
+	void StreamingBuffer::Unmap()
+	{
+		if (m_mappedData == nullptr)
+		{
+			GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef _CE_STREAMING_BUFFER_H_
+#define _CE_STREAMING_BUFFER_H_
+
+#include <cstddef>
+#include <vector>
+
+typedef unsigned int GLuint;
+typedef struct __GLsync* GLsync;
+
+namespace CE
+{
+	struct StreamingAllocation
+	{
+		GLuint buffer;
+		size_t offset;
+		size_t size;
+
+		bool IsValid() const { return buffer != 0; }
+	};
+
+	// A ring of per-frame regions in one buffer, for data that is written once
+	// per frame and read by the GPU in that frame. Writing never synchronizes
+	// with the GPU: a fence is placed at the end of each frame, and a region is
+	// only reused once its fence has signaled.
+	//
+	// The buffer is persistently mapped where ARB_buffer_storage is available.
+	// Otherwise each allocation is written through an unsynchronized map.
+	class StreamingBuffer
+	{
+	public:
+		static const size_t DEFAULT_ALIGNMENT = 16;
+
+		StreamingBuffer(size_t frameSize);
+		~StreamingBuffer();
+		StreamingBuffer(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+		// Waits (normally not at all) until the GPU is done with the next region.
+		void BeginFrame();
+		void EndFrame();
+
+		// Returns an invalid allocation if the frame's region is full.
+		StreamingAllocation Allocate(const void* data, size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+
+		template<typename T>
+		StreamingAllocation Allocate(const std::vector<T>& data, size_t alignment = DEFAULT_ALIGNMENT)
+		{
+			return Allocate(data.data(), data.size() * sizeof(T), alignment);
+		}
+
+		// Like Allocate, but leaves the data to be written in place, through
+		// the pointer, until Unmap. Nothing else may use the buffer meanwhile.
+		StreamingAllocation Map(size_t size, void** data, size_t alignment = DEFAULT_ALIGNMENT);
+		void Unmap();
+
+		// Required offset alignment for texture buffers that view this buffer.
+		size_t GetTextureBufferAlignment() const { return m_textureBufferAlignment; }
+
+	private:
+		static const unsigned FRAME_COUNT = 3;
+
+		GLuint m_buffer;
+		unsigned char* m_mappedData;
+		size_t m_frameSize;
+		size_t m_frameOffset;
+		unsigned m_frame;
+		GLsync m_fences[FRAME_COUNT];
+		size_t m_textureBufferAlignment;
+	};
+}
+
+#endif // _CE_STREAMING_BUFFER_H_
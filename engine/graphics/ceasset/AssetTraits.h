@@ -13,7 +13,17 @@ namespace CE
 		SKELETON = 0,
 		MESH,
 		ANIMATION,
-		TEXTURE
+		TEXTURE,
+
+		// Optional chunks that extend the preceding MESH.
+		MESH_INFLUENCE_RANGES,
+		MESH_COMPACT_VERTICES,
+		MESH_SHORT_INDICES,
+		MESH_BOUNDS,
+		MESH_LODS,
+
+		// Optional chunks that extend the preceding SKELETON.
+		SKELETON_JOINT_BOUNDS
 	};
 }
 
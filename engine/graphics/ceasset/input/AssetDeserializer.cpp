@@ -40,6 +40,13 @@ namespace CE
 		}
 	}
 
+	void AssetDeserializer::ReadSkeletonJointBounds(Skeleton& outSkeleton)
+	{
+		const auto boundsCount = stream.Read<unsigned>();
+		outSkeleton.jointBounds.resize(boundsCount);
+		stream.Read(outSkeleton.jointBounds.data(), boundsCount);
+	}
+
 	void AssetDeserializer::ReadMesh(Mesh& outMesh)
 	{
 		const auto verticesCount = stream.Read<unsigned>();
@@ -59,6 +66,43 @@ namespace CE
 		stream >> outMesh.m_normalIndex;
 	}
 
+	void AssetDeserializer::ReadMeshInfluenceRanges(Mesh& outMesh)
+	{
+		const auto rangesCount = stream.Read<unsigned>();
+		outMesh.m_influenceRangeCounts.resize(rangesCount);
+		stream.Read(outMesh.m_influenceRangeCounts.data(), rangesCount);
+	}
+
+	void AssetDeserializer::ReadMeshCompactVertices(Mesh& outMesh)
+	{
+		stream >> outMesh.m_positionMin;
+		stream >> outMesh.m_positionExtent;
+
+		const auto verticesCount = stream.Read<unsigned>();
+		outMesh.m_compactVertices.resize(verticesCount);
+		stream.Read(outMesh.m_compactVertices.data(), verticesCount);
+	}
+
+	void AssetDeserializer::ReadMeshShortIndices(Mesh& outMesh)
+	{
+		const auto indicesCount = stream.Read<unsigned>();
+		outMesh.m_shortIndices.resize(indicesCount);
+		stream.Read(outMesh.m_shortIndices.data(), indicesCount);
+	}
+
+	void AssetDeserializer::ReadMeshBounds(Mesh& outMesh)
+	{
+		stream >> outMesh.m_boundsMin;
+		stream >> outMesh.m_boundsMax;
+	}
+
+	void AssetDeserializer::ReadMeshLods(Mesh& outMesh)
+	{
+		const auto lodCount = stream.Read<unsigned>();
+		outMesh.m_lodIndexCounts.resize(lodCount);
+		stream.Read(outMesh.m_lodIndexCounts.data(), lodCount);
+	}
+
 	void AssetDeserializer::ReadAnimation(Animation& outAnimation)
 	{
 		stream >> outAnimation.name;
@@ -27,7 +27,13 @@ namespace CE
 		bool ReadAndVerifyHeader();
 		AssetType ReadAssetType();
 		void ReadSkeleton(Skeleton& outSkeleton);
+		void ReadSkeletonJointBounds(Skeleton& outSkeleton);
 		void ReadMesh(Mesh& outMesh);
+		void ReadMeshInfluenceRanges(Mesh& outMesh);
+		void ReadMeshCompactVertices(Mesh& outMesh);
+		void ReadMeshShortIndices(Mesh& outMesh);
+		void ReadMeshBounds(Mesh& outMesh);
+		void ReadMeshLods(Mesh& outMesh);
 		void ReadAnimation(Animation& outAnimation);
 		void ReadTexture(Texture& outTexture);
 
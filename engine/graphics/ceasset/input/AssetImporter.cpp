@@ -39,11 +39,35 @@ namespace CE
 					deserializer.ReadSkeleton(outSkeleton);
 					break;
 
+				case AssetType::SKELETON_JOINT_BOUNDS:
+					deserializer.ReadSkeletonJointBounds(outSkeleton);
+					break;
+
 				case AssetType::MESH:
 					outMeshes.push_back(Mesh());
 					deserializer.ReadMesh(outMeshes.back());
 					break;
 
+				case AssetType::MESH_INFLUENCE_RANGES:
+					deserializer.ReadMeshInfluenceRanges(outMeshes.back());
+					break;
+
+				case AssetType::MESH_COMPACT_VERTICES:
+					deserializer.ReadMeshCompactVertices(outMeshes.back());
+					break;
+
+				case AssetType::MESH_SHORT_INDICES:
+					deserializer.ReadMeshShortIndices(outMeshes.back());
+					break;
+
+				case AssetType::MESH_BOUNDS:
+					deserializer.ReadMeshBounds(outMeshes.back());
+					break;
+
+				case AssetType::MESH_LODS:
+					deserializer.ReadMeshLods(outMeshes.back());
+					break;
+
 				case AssetType::ANIMATION:
 					outAnimations.push_back(Animation());
 					deserializer.ReadAnimation(outAnimations.back());
@@ -33,14 +33,24 @@ namespace CE
 			stream.Write(joint.name.data(), joint.name.size() + 1);
 			stream << joint.parentIndex;
 		}
+
+		if (!skeleton.jointBounds.empty())
+		{
+			stream << AssetType::SKELETON_JOINT_BOUNDS;
+
+			stream << static_cast<unsigned>(skeleton.jointBounds.size());
+			stream.Write(skeleton.jointBounds.data(), skeleton.jointBounds.size());
+		}
 	}
 
 	void AssetSerializer::WriteMesh(const Mesh& mesh)
 	{
 		stream << AssetType::MESH;
 
-		stream << static_cast<unsigned>(mesh.m_vertices.size());
-		stream.Write(mesh.m_vertices.data(), mesh.m_vertices.size());
+		// The compact vertices replace the floats, which the engine then never reads.
+		const size_t vertexCount = mesh.m_compactVertices.empty() ? mesh.m_vertices.size() : 0;
+		stream << static_cast<unsigned>(vertexCount);
+		stream.Write(mesh.m_vertices.data(), vertexCount);
 
 		stream << static_cast<unsigned>(mesh.m_indices.size());
 		stream.Write(mesh.m_indices.data(), mesh.m_indices.size());
@@ -52,6 +62,49 @@ namespace CE
 		stream << mesh.m_diffuseIndex;
 		stream << mesh.m_specularIndex;
 		stream << mesh.m_normalIndex;
+
+		if (!mesh.m_influenceRangeCounts.empty())
+		{
+			stream << AssetType::MESH_INFLUENCE_RANGES;
+
+			stream << static_cast<unsigned>(mesh.m_influenceRangeCounts.size());
+			stream.Write(mesh.m_influenceRangeCounts.data(), mesh.m_influenceRangeCounts.size());
+		}
+
+		if (!mesh.m_shortIndices.empty())
+		{
+			stream << AssetType::MESH_SHORT_INDICES;
+
+			stream << static_cast<unsigned>(mesh.m_shortIndices.size());
+			stream.Write(mesh.m_shortIndices.data(), mesh.m_shortIndices.size());
+		}
+
+		if (!mesh.m_compactVertices.empty())
+		{
+			stream << AssetType::MESH_COMPACT_VERTICES;
+
+			stream << mesh.m_positionMin;
+			stream << mesh.m_positionExtent;
+
+			stream << static_cast<unsigned>(mesh.m_compactVertices.size());
+			stream.Write(mesh.m_compactVertices.data(), mesh.m_compactVertices.size());
+		}
+
+		if (!mesh.m_lodIndexCounts.empty())
+		{
+			stream << AssetType::MESH_LODS;
+
+			stream << static_cast<unsigned>(mesh.m_lodIndexCounts.size());
+			stream.Write(mesh.m_lodIndexCounts.data(), mesh.m_lodIndexCounts.size());
+		}
+
+		if (mesh.m_boundsMin.x <= mesh.m_boundsMax.x)
+		{
+			stream << AssetType::MESH_BOUNDS;
+
+			stream << mesh.m_boundsMin;
+			stream << mesh.m_boundsMax;
+		}
 	}
 
 	void AssetSerializer::WriteMeshes(const Meshes& meshes)
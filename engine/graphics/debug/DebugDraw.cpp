@@ -0,0 +1,172 @@
+#include "DebugDraw.h"
+
+#include "graphics/buffer/BufferStorage.h"
+#include "graphics/buffer/StreamingBuffer.h"
+#include "graphics/render/GLStateCache.h"
+#include "graphics/skeleton/Skeleton.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+namespace CE
+{
+	static const glm::vec3 JOINT_COLOR(1.f, 0.f, 0.f);
+	static const glm::vec3 BONE_COLOR(1.f, 1.f, 0.f);
+
+	DebugDraw::DebugDraw()
+		: m_vertexArray(0)
+		, m_gridVertexBuffer(0)
+		, m_gridVertexArray(0)
+		, m_gridVertexCount(0)
+	{
+		glGenVertexArrays(1, &m_vertexArray);
+		GLStateCache::Get().BindVertexArray(m_vertexArray);
+		GLStateCache::Get().EnableVertexAttribArray(0);
+		GLStateCache::Get().EnableVertexAttribArray(1);
+		GLStateCache::Get().BindVertexArray(0);
+
+		InitializeGrid();
+	}
+
+	DebugDraw::~DebugDraw()
+	{
+		GLStateCache::Get().DeleteVertexArrays(1, &m_gridVertexArray);
+		GLStateCache::Get().DeleteBuffers(1, &m_gridVertexBuffer);
+		GLStateCache::Get().DeleteVertexArrays(1, &m_vertexArray);
+	}
+
+	void DebugDraw::InitializeGrid()
+	{
+		std::vector<glm::vec3> gridVertices;
+
+		int sideLength = 2000;
+		int halfSideLength = sideLength / 2;
+		int increment = 100;
+
+		for (int i = -halfSideLength; i <= halfSideLength; i += increment)
+		{
+			gridVertices.push_back(glm::vec3(i, 0, halfSideLength));
+			gridVertices.push_back(glm::vec3(i, 0, -halfSideLength));
+			gridVertices.push_back(glm::vec3(halfSideLength, 0, i));
+			gridVertices.push_back(glm::vec3(-halfSideLength, 0, i));
+		}
+
+		m_gridVertexCount = (GLsizei) gridVertices.size();
+
+		glGenVertexArrays(1, &m_gridVertexArray);
+		GLStateCache::Get().BindVertexArray(m_gridVertexArray);
+
+		glGenBuffers(1, &m_gridVertexBuffer);
+		GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_gridVertexBuffer);
+		AllocateStaticBufferStorage(GL_ARRAY_BUFFER, gridVertices.size() * sizeof(glm::vec3), gridVertices.data());
+
+		// Color is hardcoded in GridShader.frag.
+		GLStateCache::Get().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0);
+		GLStateCache::Get().EnableVertexAttribArray(0);
+
+		GLStateCache::Get().BindVertexArray(0);
+	}
+
+	void DebugDraw::AddPoint(const glm::vec3& position, const glm::vec3& color)
+	{
+		m_points.push_back({ position, color });
+	}
+
+	void DebugDraw::AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec3& color)
+	{
+		m_lines.push_back({ start, color });
+		m_lines.push_back({ end, color });
+	}
+
+	void DebugDraw::AddSkeleton(const Skeleton& skeleton, const glm::mat4* palette, const glm::mat4& model)
+	{
+		const std::vector<glm::vec3>& bindPoseJointPositions = GetBindPoseJointPositions(skeleton);
+
+		// The palette maps bind pose positions to posed positions, so only a
+		// transform per joint is needed, and never a decomposition.
+		const size_t firstPoint = m_points.size();
+		for (size_t i = 0; i < skeleton.joints.size(); ++i)
+		{
+			AddPoint(glm::vec3(model * palette[i] * glm::vec4(bindPoseJointPositions[i], 1.f)), JOINT_COLOR);
+		}
+
+		for (size_t i = 0; i < skeleton.joints.size(); ++i)
+		{
+			const short parentIndex = skeleton.joints[i].parentIndex;
+			if (parentIndex != -1)
+			{
+				AddLine(m_points[firstPoint + parentIndex].position, m_points[firstPoint + i].position, BONE_COLOR);
+			}
+		}
+	}
+
+	const std::vector<glm::vec3>& DebugDraw::GetBindPoseJointPositions(const Skeleton& skeleton)
+	{
+		auto it = m_bindPoseJointPositions.find(&skeleton);
+		if (it != m_bindPoseJointPositions.end())
+		{
+			return it->second;
+		}
+
+		std::vector<glm::vec3>& positions = m_bindPoseJointPositions[&skeleton];
+		positions.reserve(skeleton.joints.size());
+		for (const Joint& joint : skeleton.joints)
+		{
+			positions.push_back(glm::vec3(glm::inverse(joint.inverseBindPose)[3]));
+		}
+		return positions;
+	}
+
+	void DebugDraw::Flush(
+		GLuint g_debugDrawProjectionViewModelMatrixId,
+		const glm::mat4& projectionViewModel,
+		StreamingBuffer& streamingBuffer)
+	{
+		glUniformMatrix4fv(g_debugDrawProjectionViewModelMatrixId, 1, GL_FALSE, &projectionViewModel[0][0]);
+
+		GLStateCache::Get().BindVertexArray(m_vertexArray);
+
+		glPointSize(5.f);
+		DrawVertices(m_points, GL_POINTS, streamingBuffer);
+
+		glLineWidth(1.f);
+		DrawVertices(m_lines, GL_LINES, streamingBuffer);
+
+		m_lines.clear();
+		m_points.clear();
+	}
+
+	void DebugDraw::DrawVertices(const std::vector<DebugVertex>& vertices, unsigned mode, StreamingBuffer& streamingBuffer)
+	{
+		if (vertices.empty())
+		{
+			return;
+		}
+
+		StreamingAllocation allocation = streamingBuffer.Allocate(vertices);
+		if (!allocation.IsValid())
+		{
+			return;
+		}
+
+		unsigned stride = sizeof(DebugVertex);
+		GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+		GLStateCache::Get().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, allocation.offset + offsetof(DebugVertex, position));
+		GLStateCache::Get().VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, allocation.offset + offsetof(DebugVertex, color));
+
+		glDrawArrays(mode, 0, (GLsizei) vertices.size());
+	}
+
+	void DebugDraw::DrawGrid(
+		GLuint g_gridProjectionViewModelMatrixId,
+		const glm::mat4& projectionViewModel)
+	{
+		glUniformMatrix4fv(g_gridProjectionViewModelMatrixId, 1, GL_FALSE, &projectionViewModel[0][0]);
+
+		GLStateCache::Get().BindVertexArray(m_gridVertexArray);
+
+		glLineWidth(1.f);
+		glDrawArrays(GL_LINES, 0, m_gridVertexCount);
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef _CE_DEBUG_DRAW_H_
+#define _CE_DEBUG_DRAW_H_
+
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+typedef unsigned int GLuint;
+typedef int GLsizei;
+
+namespace CE
+{
+	struct Skeleton;
+	class StreamingBuffer;
+
+	// Collects debug points and lines from every caller during a frame, and
+	// draws them with one draw call per primitive type. The grid never changes,
+	// so it is built and uploaded once.
+	class DebugDraw
+	{
+	public:
+		DebugDraw();
+		~DebugDraw();
+		DebugDraw(const DebugDraw&) = delete;
+		DebugDraw& operator=(const DebugDraw&) = delete;
+
+		void AddPoint(const glm::vec3& position, const glm::vec3& color);
+		void AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec3& color);
+
+		// Joints as points and bones as lines, posed by the skeleton's skinning
+		// palette of one matrix per joint, and placed in the world by model.
+		void AddSkeleton(const Skeleton& skeleton, const glm::mat4* palette, const glm::mat4& model);
+
+		// Expects the debug draw program to be in use. Clears everything added.
+		void Flush(
+			GLuint g_debugDrawProjectionViewModelMatrixId,
+			const glm::mat4& projectionViewModel,
+			StreamingBuffer& streamingBuffer);
+
+		// Expects the grid program to be in use.
+		void DrawGrid(
+			GLuint g_gridProjectionViewModelMatrixId,
+			const glm::mat4& projectionViewModel);
+
+	private:
+		struct DebugVertex
+		{
+			glm::vec3 position;
+			glm::vec3 color;
+		};
+
+		void InitializeGrid();
+		const std::vector<glm::vec3>& GetBindPoseJointPositions(const Skeleton& skeleton);
+		void DrawVertices(const std::vector<DebugVertex>& vertices, unsigned mode, StreamingBuffer& streamingBuffer);
+
+		std::vector<DebugVertex> m_points;
+		std::vector<DebugVertex> m_lines;
+		GLuint m_vertexArray;
+
+		std::unordered_map<const Skeleton*, std::vector<glm::vec3>> m_bindPoseJointPositions;
+
+		GLuint m_gridVertexBuffer;
+		GLuint m_gridVertexArray;
+		GLsizei m_gridVertexCount;
+	};
+}
+
+#endif // _CE_DEBUG_DRAW_H_
@@ -0,0 +1,292 @@
+#include "CpuSkinner.h"
+
+#include "Mesh.h"
+#include "Vertex.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+
+// SSE is always there on x64. Other architectures use the plain glm kernel.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CE_CPU_SKINNER_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace CE
+{
+	// Vertices per chunk. Meshes with a single chunk are skinned by the calling
+	// thread alone, since waking the workers costs more than it saves.
+	static const size_t SKINNING_CHUNK_SIZE = 2048;
+
+	// Joint weights of a vertex, in the order of its joint indices. Follows
+	// SkinningShader.vert: the last weight is implicit, and vertices in the 2
+	// influence range only store the first.
+	template<unsigned INFLUENCES>
+	static void GetJointWeights(const Vertex1P1UV4J& vertex, float (&weights)[4])
+	{
+		if (INFLUENCES == 1)
+		{
+			weights[0] = 1.f;
+		}
+		else if (INFLUENCES == 2)
+		{
+			weights[0] = vertex.jointWeights[0];
+			weights[1] = 1.f - vertex.jointWeights[0];
+		}
+		else
+		{
+			weights[0] = vertex.jointWeights[0];
+			weights[1] = vertex.jointWeights[1];
+			weights[2] = vertex.jointWeights[2];
+			weights[3] = 1.f - (vertex.jointWeights[0] + vertex.jointWeights[1] + vertex.jointWeights[2]);
+		}
+	}
+
+#ifdef CE_CPU_SKINNER_SSE
+	template<unsigned INFLUENCES>
+	static void SkinVertex(const glm::mat4* palette, const Vertex1P1UV4J& vertex, Vertex1P1UV& skinnedVertex)
+	{
+		float weights[4];
+		GetJointWeights<INFLUENCES>(vertex, weights);
+
+		// Blends the joint matrices a column at a time, then transforms once.
+		// Palettes are not necessarily 16 byte aligned.
+		__m128 columns[4];
+		const float* joint = &palette[vertex.jointIndices[0]][0][0];
+		const __m128 firstWeight = _mm_set1_ps(weights[0]);
+		for (unsigned column = 0; column < 4; ++column)
+		{
+			columns[column] = INFLUENCES == 1
+				? _mm_loadu_ps(joint + column * 4)
+				: _mm_mul_ps(_mm_loadu_ps(joint + column * 4), firstWeight);
+		}
+
+		for (unsigned influence = 1; influence < INFLUENCES; ++influence)
+		{
+			joint = &palette[vertex.jointIndices[influence]][0][0];
+			const __m128 weight = _mm_set1_ps(weights[influence]);
+			for (unsigned column = 0; column < 4; ++column)
+			{
+				columns[column] = _mm_add_ps(columns[column], _mm_mul_ps(_mm_loadu_ps(joint + column * 4), weight));
+			}
+		}
+
+		__m128 position = columns[3];
+		position = _mm_add_ps(position, _mm_mul_ps(columns[0], _mm_set1_ps(vertex.position.x)));
+		position = _mm_add_ps(position, _mm_mul_ps(columns[1], _mm_set1_ps(vertex.position.y)));
+		position = _mm_add_ps(position, _mm_mul_ps(columns[2], _mm_set1_ps(vertex.position.z)));
+
+		// Exactly x, y and z; the position is only 12 bytes.
+		_mm_storel_pi(reinterpret_cast<__m64*>(&skinnedVertex.position.x), position);
+		_mm_store_ss(&skinnedVertex.position.z, _mm_movehl_ps(position, position));
+		skinnedVertex.uv[0] = vertex.uv[0];
+		skinnedVertex.uv[1] = vertex.uv[1];
+	}
+#else
+	template<unsigned INFLUENCES>
+	static void SkinVertex(const glm::mat4* palette, const Vertex1P1UV4J& vertex, Vertex1P1UV& skinnedVertex)
+	{
+		float weights[4];
+		GetJointWeights<INFLUENCES>(vertex, weights);
+
+		glm::mat4 joint = palette[vertex.jointIndices[0]] * weights[0];
+		for (unsigned influence = 1; influence < INFLUENCES; ++influence)
+		{
+			joint += palette[vertex.jointIndices[influence]] * weights[influence];
+		}
+
+		skinnedVertex.position = glm::vec3(joint * glm::vec4(vertex.position, 1.f));
+		skinnedVertex.uv[0] = vertex.uv[0];
+		skinnedVertex.uv[1] = vertex.uv[1];
+	}
+#endif
+
+	template<unsigned INFLUENCES>
+	static void SkinVertexRange(
+		const glm::mat4* palette,
+		const Vertex1P1UV4J* vertices,
+		Vertex1P1UV* skinnedVertices,
+		size_t firstVertex,
+		size_t endVertex)
+	{
+		for (size_t i = firstVertex; i < endVertex; ++i)
+		{
+			SkinVertex<INFLUENCES>(palette, vertices[i], skinnedVertices[i]);
+		}
+	}
+
+	// Dequantizes a compact vertex the same way the GPU does with the attribute
+	// formats MeshComponent sets up for it.
+	static Vertex1P1UV4J DecodeVertex(const Vertex1P1UV4JCompact& compactVertex, const glm::vec3& positionMin, const glm::vec3& positionScale)
+	{
+		Vertex1P1UV4J vertex;
+		vertex.position = positionMin + positionScale * glm::vec3(compactVertex.position[0], compactVertex.position[1], compactVertex.position[2]);
+		vertex.uv[0] = glm::unpackHalf1x16(compactVertex.uv[0]);
+		vertex.uv[1] = glm::unpackHalf1x16(compactVertex.uv[1]);
+		std::copy(compactVertex.jointIndices, compactVertex.jointIndices + 4, vertex.jointIndices);
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			vertex.jointWeights[i] = compactVertex.jointWeights[i] / 255.f;
+		}
+		return vertex;
+	}
+
+	template<unsigned INFLUENCES>
+	static void SkinCompactVertexRange(
+		const glm::mat4* palette,
+		const Mesh& mesh,
+		Vertex1P1UV* skinnedVertices,
+		size_t firstVertex,
+		size_t endVertex)
+	{
+		const Vertex1P1UV4JCompact* vertices = mesh.m_compactVertices.data();
+		const glm::vec3 positionScale = mesh.m_positionExtent / 65535.f;
+		for (size_t i = firstVertex; i < endVertex; ++i)
+		{
+			SkinVertex<INFLUENCES>(palette, DecodeVertex(vertices[i], mesh.m_positionMin, positionScale), skinnedVertices[i]);
+		}
+	}
+
+	CpuSkinner::CpuSkinner(unsigned workerCount)
+		: m_generation(0)
+		, m_busyWorkers(0)
+		, m_stopping(false)
+		, m_palette(nullptr)
+		, m_mesh(nullptr)
+		, m_skinnedVertices(nullptr)
+		, m_influenceRangeEnds{ 0, 0 }
+		, m_chunkCount(0)
+		, m_nextChunk(0)
+	{
+		for (unsigned i = 0; i < workerCount; ++i)
+		{
+			m_workers.push_back(std::thread(&CpuSkinner::Run, this));
+		}
+	}
+
+	CpuSkinner::~CpuSkinner()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_workCondition.notify_all();
+
+		for (std::thread& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	void CpuSkinner::Skin(const glm::mat4* palette, const Mesh& mesh, Vertex1P1UV* skinnedVertices)
+	{
+		const size_t vertexCount = mesh.GetVertexCount();
+
+		m_palette = palette;
+		m_mesh = &mesh;
+		m_skinnedVertices = skinnedVertices;
+
+		// Meshes that were never partitioned are all skinned with 4 influences.
+		if (mesh.m_influenceRangeCounts.size() == 3)
+		{
+			m_influenceRangeEnds[0] = mesh.m_influenceRangeCounts[0];
+			m_influenceRangeEnds[1] = m_influenceRangeEnds[0] + mesh.m_influenceRangeCounts[1];
+		}
+		else
+		{
+			m_influenceRangeEnds[0] = 0;
+			m_influenceRangeEnds[1] = 0;
+		}
+
+		m_chunkCount = (vertexCount + SKINNING_CHUNK_SIZE - 1) / SKINNING_CHUNK_SIZE;
+		m_nextChunk = 0;
+
+		if (m_workers.empty() || m_chunkCount <= 1)
+		{
+			SkinChunks();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_generation;
+			m_busyWorkers = (unsigned) m_workers.size();
+		}
+		m_workCondition.notify_all();
+
+		SkinChunks();
+
+		// Every worker has to see the generation before the next mesh starts.
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this]() { return m_busyWorkers == 0; });
+	}
+
+	void CpuSkinner::Run()
+	{
+		uint64_t generation = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workCondition.wait(lock, [this, generation]() { return m_stopping || m_generation != generation; });
+				if (m_stopping)
+				{
+					return;
+				}
+				generation = m_generation;
+			}
+
+			SkinChunks();
+
+			bool isLastWorker;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				isLastWorker = --m_busyWorkers == 0;
+			}
+			if (isLastWorker)
+			{
+				m_doneCondition.notify_one();
+			}
+		}
+	}
+
+	void CpuSkinner::SkinChunks()
+	{
+		const size_t vertexCount = m_mesh->GetVertexCount();
+		while (true)
+		{
+			const size_t chunk = m_nextChunk++;
+			if (chunk >= m_chunkCount)
+			{
+				return;
+			}
+
+			const size_t firstVertex = chunk * SKINNING_CHUNK_SIZE;
+			SkinVertices(firstVertex, std::min(firstVertex + SKINNING_CHUNK_SIZE, vertexCount));
+		}
+	}
+
+	void CpuSkinner::SkinVertices(size_t firstVertex, size_t endVertex)
+	{
+		// A chunk may span influence ranges.
+		const size_t oneEnd = std::min(endVertex, m_influenceRangeEnds[0]);
+		const size_t twoEnd = std::min(endVertex, m_influenceRangeEnds[1]);
+		const size_t twoFirst = std::max(firstVertex, m_influenceRangeEnds[0]);
+		const size_t fourFirst = std::max(firstVertex, m_influenceRangeEnds[1]);
+
+		// Assets with compact vertices no longer store the floats.
+		if (!m_mesh->m_compactVertices.empty())
+		{
+			SkinCompactVertexRange<1>(m_palette, *m_mesh, m_skinnedVertices, firstVertex, oneEnd);
+			SkinCompactVertexRange<2>(m_palette, *m_mesh, m_skinnedVertices, twoFirst, twoEnd);
+			SkinCompactVertexRange<4>(m_palette, *m_mesh, m_skinnedVertices, fourFirst, endVertex);
+			return;
+		}
+
+		const Vertex1P1UV4J* vertices = m_mesh->m_vertices.data();
+		SkinVertexRange<1>(m_palette, vertices, m_skinnedVertices, firstVertex, oneEnd);
+		SkinVertexRange<2>(m_palette, vertices, m_skinnedVertices, twoFirst, twoEnd);
+		SkinVertexRange<4>(m_palette, vertices, m_skinnedVertices, fourFirst, endVertex);
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef _CE_CPU_SKINNER_H_
+#define _CE_CPU_SKINNER_H_
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CE
+{
+	struct Mesh;
+	struct Vertex1P1UV;
+
+	// Skins a mesh's vertices, compact or not, into model-space Vertex1P1UV
+	// on the CPU, the same way SkinningShader.vert does. Meant for software
+	// renderers, where the vertex shader is far slower than the CPU. Large
+	// meshes are split into chunks, shared by the calling thread and a pool
+	// of workers.
+	class CpuSkinner
+	{
+	public:
+		CpuSkinner(unsigned workerCount);
+		~CpuSkinner();
+		CpuSkinner(const CpuSkinner&) = delete;
+		CpuSkinner& operator=(const CpuSkinner&) = delete;
+
+		// Blocks until every vertex is skinned. skinnedVertices must hold as
+		// many vertices as the mesh.
+		void Skin(const glm::mat4* palette, const Mesh& mesh, Vertex1P1UV* skinnedVertices);
+
+	private:
+		void Run();
+		void SkinChunks();
+		void SkinVertices(size_t firstVertex, size_t endVertex);
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_workCondition;
+		std::condition_variable m_doneCondition;
+		uint64_t m_generation;
+		unsigned m_busyWorkers;
+		bool m_stopping;
+
+		// The mesh being skinned.
+		const glm::mat4* m_palette;
+		const Mesh* m_mesh;
+		Vertex1P1UV* m_skinnedVertices;
+		// Ends of the 1 and 2 influence ranges; the 4 influence range runs to the end.
+		size_t m_influenceRangeEnds[2];
+		size_t m_chunkCount;
+		std::atomic<size_t> m_nextChunk;
+	};
+}
+
+#endif // _CE_CPU_SKINNER_H_
@@ -3,6 +3,7 @@
 
 #include "Vertex.h"
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -10,8 +11,17 @@ namespace CE
 {
 	struct Mesh
 	{
+		// Vertices with full precision floats. Assets only store them when there
+		// are no m_compactVertices, so only the converter has both.
 		std::vector<Vertex1P1UV4J> m_vertices;
 		std::vector<unsigned int> m_indices;
+		// Used instead of m_indices by meshes with fewer than 65536 vertices;
+		// only one of the two is ever filled.
+		std::vector<uint16_t> m_shortIndices;
+		// Index counts of each level of detail, finest first. The levels are
+		// stored back to back in the indices and share the vertices. Empty if
+		// the mesh has a single level.
+		std::vector<unsigned> m_lodIndexCounts;
 
 		std::string m_diffuseMapName;
 		std::string m_specularMapName;
@@ -20,6 +30,27 @@ namespace CE
 		uint8_t m_diffuseIndex;
 		uint8_t m_specularIndex;
 		uint8_t m_normalIndex;
+
+		// Vertex counts of the 1, 2 and up to 4 joint influence ranges, which are
+		// stored in that order. Empty if the vertices were never partitioned.
+		std::vector<unsigned> m_influenceRangeCounts;
+
+		// Quantized copy of m_vertices, drawn and skinned instead of them when
+		// present. Empty for assets converted before the compact format existed.
+		std::vector<Vertex1P1UV4JCompact> m_compactVertices;
+		// Compact positions decode to m_positionMin + m_positionExtent * position.
+		glm::vec3 m_positionMin = glm::vec3(0.f);
+		glm::vec3 m_positionExtent = glm::vec3(1.f);
+
+		// Model-space box around the mesh in its bind pose and in every frame of
+		// every animation in the asset. Empty (min > max) for older assets.
+		glm::vec3 m_boundsMin = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 m_boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+
+		size_t GetVertexCount() const
+		{
+			return m_compactVertices.empty() ? m_vertices.size() : m_compactVertices.size();
+		}
 	};
 
 	typedef std::vector<Mesh> Meshes;
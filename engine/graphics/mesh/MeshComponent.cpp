@@ -1,66 +1,290 @@
 #include "MeshComponent.h"
 
 #include "Mesh.h"
+#include "MeshInstance.h"
+#include "SkinnedMeshCache.h"
+#include "graphics/buffer/BufferStorage.h"
+#include "graphics/render/GLStateCache.h"
 #include "graphics/texture/Texture.h"
-#include "graphics/texture/TextureManager.h"
+#include "graphics/texture/TextureCache.h"
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <cstddef>
+
 namespace CE
 {
 	MeshComponent::MeshComponent(Meshes* meshes, Textures* textures)
 		: m_meshes(meshes)
 		, m_textures(textures)
+		, m_lodCount(1)
+		, m_hasBounds(false)
+	{
+		InitializeBuffers();
+		InitializeTextures();
+		InitializeBounds();
+	}
+
+	MeshComponent::~MeshComponent()
+	{
+		GLStateCache::Get().DeleteVertexArrays((GLsizei) m_vertexArrays.size(), m_vertexArrays.data());
+		GLStateCache::Get().DeleteBuffers((GLsizei) m_indexBuffers.size(), m_indexBuffers.data());
+		GLStateCache::Get().DeleteBuffers((GLsizei) m_vertexBuffers.size(), m_vertexBuffers.data());
+	}
+
+	void MeshComponent::InitializeBounds()
+	{
+		m_hasBounds = !m_meshes->empty();
+		m_boundsMin = glm::vec3(0.f);
+		m_boundsMax = glm::vec3(0.f);
+
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			const Mesh& mesh = m_meshes->at(i);
+
+			// One mesh without bounds leaves the whole asset unbounded.
+			if (mesh.m_boundsMin.x > mesh.m_boundsMax.x)
+			{
+				m_hasBounds = false;
+				return;
+			}
+
+			m_boundsMin = i == 0 ? mesh.m_boundsMin : glm::min(m_boundsMin, mesh.m_boundsMin);
+			m_boundsMax = i == 0 ? mesh.m_boundsMax : glm::max(m_boundsMax, mesh.m_boundsMax);
+		}
+	}
+
+	void MeshComponent::InitializeBuffers()
+	{
+		m_vertexBuffers.resize(m_meshes->size());
+		m_indexBuffers.resize(m_meshes->size());
+		m_vertexArrays.resize(m_meshes->size());
+		m_indexTypes.resize(m_meshes->size());
+		m_lodFirstIndices.resize(m_meshes->size());
+		glGenBuffers((GLsizei) m_vertexBuffers.size(), m_vertexBuffers.data());
+		glGenBuffers((GLsizei) m_indexBuffers.size(), m_indexBuffers.data());
+		glGenVertexArrays((GLsizei) m_vertexArrays.size(), m_vertexArrays.data());
+
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			const Mesh& mesh = m_meshes->at(i);
+
+			GLStateCache::Get().BindVertexArray(m_vertexArrays[i]);
+
+			GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_vertexBuffers[i]);
+			if (!mesh.m_compactVertices.empty())
+			{
+				AllocateStaticBufferStorage(GL_ARRAY_BUFFER, mesh.m_compactVertices.size() * sizeof(Vertex1P1UV4JCompact), mesh.m_compactVertices.data());
+			}
+			else
+			{
+				AllocateStaticBufferStorage(GL_ARRAY_BUFFER, mesh.m_vertices.size() * sizeof(Vertex1P1UV4J), mesh.m_vertices.data());
+			}
+
+			// The element array binding is part of the vertex array state.
+			GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffers[i]);
+			if (!mesh.m_shortIndices.empty())
+			{
+				AllocateStaticBufferStorage(GL_ELEMENT_ARRAY_BUFFER, mesh.m_shortIndices.size() * sizeof(uint16_t), mesh.m_shortIndices.data());
+				m_indexTypes[i] = GL_UNSIGNED_SHORT;
+			}
+			else
+			{
+				AllocateStaticBufferStorage(GL_ELEMENT_ARRAY_BUFFER, mesh.m_indices.size() * sizeof(unsigned int), mesh.m_indices.data());
+				m_indexTypes[i] = GL_UNSIGNED_INT;
+			}
+
+			std::vector<GLsizei>& lodFirstIndices = m_lodFirstIndices[i];
+			lodFirstIndices.assign(1, 0);
+			for (unsigned indexCount : mesh.m_lodIndexCounts)
+			{
+				lodFirstIndices.push_back(lodFirstIndices.back() + (GLsizei) indexCount);
+			}
+			if (lodFirstIndices.size() == 1)
+			{
+				lodFirstIndices.push_back((GLsizei) (mesh.m_shortIndices.empty() ? mesh.m_indices.size() : mesh.m_shortIndices.size()));
+			}
+			m_lodCount = std::max(m_lodCount, (unsigned) lodFirstIndices.size() - 1);
+
+			InitializeVertexAttributes(mesh);
+		}
+
+		GLStateCache::Get().BindVertexArray(0);
+	}
+
+	void MeshComponent::InitializeVertexAttributes(const Mesh& mesh)
 	{
+		if (!mesh.m_compactVertices.empty())
+		{
+			// Normalized integers and half floats arrive in the shader as the same floats.
+			unsigned int stride = sizeof(Vertex1P1UV4JCompact);
+			GLStateCache::Get().VertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, offsetof(Vertex1P1UV4JCompact, position));
+			GLStateCache::Get().VertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, offsetof(Vertex1P1UV4JCompact, uv));
+			GLStateCache::Get().VertexAttribIPointer(2, 4, GL_UNSIGNED_BYTE, stride, offsetof(Vertex1P1UV4JCompact, jointIndices));
+			GLStateCache::Get().VertexAttribPointer(3, 3, GL_UNSIGNED_BYTE, GL_TRUE, stride, offsetof(Vertex1P1UV4JCompact, jointWeights));
+		}
+		else
+		{
+			unsigned int stride = sizeof(Vertex1P1UV4J);
+			GLStateCache::Get().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex1P1UV4J, position));
+			GLStateCache::Get().VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex1P1UV4J, uv));
+			GLStateCache::Get().VertexAttribIPointer(2, 4, GL_UNSIGNED_BYTE, stride, offsetof(Vertex1P1UV4J, jointIndices));
+			GLStateCache::Get().VertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex1P1UV4J, jointWeights));
+		}
+
+		GLStateCache::Get().EnableVertexAttribArray(0);
+		GLStateCache::Get().EnableVertexAttribArray(1);
+		GLStateCache::Get().EnableVertexAttribArray(2);
+		GLStateCache::Get().EnableVertexAttribArray(3);
+	}
+
+	void MeshComponent::SetPositionDecodeAttributes(size_t meshIndex) const
+	{
+		const Mesh& mesh = m_meshes->at(meshIndex);
+		if (!mesh.m_compactVertices.empty())
+		{
+			glVertexAttrib4f(MESH_POSITION_MIN_LOCATION, mesh.m_positionMin.x, mesh.m_positionMin.y, mesh.m_positionMin.z, 0.f);
+			glVertexAttrib4f(MESH_POSITION_EXTENT_LOCATION, mesh.m_positionExtent.x, mesh.m_positionExtent.y, mesh.m_positionExtent.z, 0.f);
+		}
+		else
+		{
+			glVertexAttrib4f(MESH_POSITION_MIN_LOCATION, 0.f, 0.f, 0.f, 0.f);
+			glVertexAttrib4f(MESH_POSITION_EXTENT_LOCATION, 1.f, 1.f, 1.f, 0.f);
+		}
+	}
+
+	void MeshComponent::InitializeTextures()
+	{
+		m_diffuseTextureIds.resize(m_meshes->size());
+
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			const Texture* texture = &(*m_textures)[m_meshes->at(i).m_diffuseIndex];
+			m_diffuseTextureIds[i] = TextureCache::Get().GetTextureId(texture);
+		}
+	}
 
+	void MeshComponent::Draw(
+		unsigned lod,
+		GLuint g_diffuseTextureLocation,
+		GLuint g_diffuseTextureUnit)
+	{
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			SetPositionDecodeAttributes(i);
+			DrawMesh(
+				i,
+				m_vertexArrays[i],
+				lod,
+				g_diffuseTextureLocation,
+				g_diffuseTextureUnit);
+		}
 	}
 
 	void MeshComponent::Draw(
-		GLuint g_vbo,
-		GLuint g_ibo,
-		GLuint g_diffuseTextureID,
+		const SkinnedMeshCache& skinnedMeshCache,
+		unsigned lod,
 		GLuint g_diffuseTextureLocation,
 		GLuint g_diffuseTextureUnit)
 	{
 		for (size_t i = 0; i < m_meshes->size(); ++i)
 		{
 			DrawMesh(
-				m_meshes->at(i),
-				g_vbo,
-				g_ibo,
-				g_diffuseTextureID,
+				i,
+				skinnedMeshCache.GetVertexArray(i),
+				lod,
 				g_diffuseTextureLocation,
 				g_diffuseTextureUnit);
 		}
 	}
 
-	void MeshComponent::DrawMesh(
-		const Mesh& mesh,
-		GLuint g_vbo,
-		GLuint g_ibo,
-		GLuint g_diffuseTextureID,
+	void MeshComponent::DrawInstanced(
+		GLuint instanceBuffer,
+		size_t instanceOffset,
+		GLsizei instanceCount,
+		unsigned lod,
 		GLuint g_diffuseTextureLocation,
 		GLuint g_diffuseTextureUnit)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, g_vbo);
-		glBufferData(GL_ARRAY_BUFFER, mesh.m_vertices.size() * sizeof(CE::Vertex1P1UV4J), mesh.m_vertices.data(), GL_STATIC_DRAW);
-
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ibo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.m_indices.size() * sizeof(unsigned int), mesh.m_indices.data(), GL_STATIC_DRAW);
-
-		const Texture& texture = (*m_textures)[mesh.m_diffuseIndex];
-
-		// TODO: How much of this has to be done every Draw() call?
-		glBindTexture(GL_TEXTURE_2D, g_diffuseTextureID);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		unsigned int glChannels = texture.channels == 3 ? GL_RGB : GL_RGBA;
-		glTexImage2D(GL_TEXTURE_2D, 0, glChannels, texture.width, texture.height, 0, glChannels, GL_UNSIGNED_BYTE, texture.data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-		glUniform1i(g_diffuseTextureLocation, g_diffuseTextureUnit);
-
-		glDrawElements(GL_TRIANGLES, (GLsizei) mesh.m_indices.size(), GL_UNSIGNED_INT, NULL);
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			GLStateCache::Get().BindVertexArray(m_vertexArrays[i]);
+			EnableInstanceAttributes(instanceBuffer, instanceOffset);
+			SetPositionDecodeAttributes(i);
+
+			DrawMesh(
+				i,
+				m_vertexArrays[i],
+				lod,
+				g_diffuseTextureLocation,
+				g_diffuseTextureUnit,
+				instanceCount);
+
+			// The same vertex arrays are drawn without instancing, with constant instance attributes.
+			DisableInstanceAttributes();
+		}
+	}
+
+	void MeshComponent::EnableInstanceAttributes(GLuint instanceBuffer, size_t instanceOffset)
+	{
+		const unsigned int stride = sizeof(MeshInstance);
+		GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+		GLStateCache::Get().VertexAttribPointer(MESH_INSTANCE_ANIMATION_LOCATION, 4, GL_FLOAT, GL_FALSE, stride, instanceOffset + offsetof(MeshInstance, animationInstance));
+		GLStateCache::Get().VertexAttribDivisor(MESH_INSTANCE_ANIMATION_LOCATION, 1);
+		GLStateCache::Get().EnableVertexAttribArray(MESH_INSTANCE_ANIMATION_LOCATION);
+
+		for (unsigned column = 0; column < 4; ++column)
+		{
+			const size_t columnOffset = offsetof(MeshInstance, model) + column * sizeof(glm::vec4);
+			GLStateCache::Get().VertexAttribPointer(MESH_INSTANCE_MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, stride, instanceOffset + columnOffset);
+			GLStateCache::Get().VertexAttribDivisor(MESH_INSTANCE_MODEL_LOCATION + column, 1);
+			GLStateCache::Get().EnableVertexAttribArray(MESH_INSTANCE_MODEL_LOCATION + column);
+		}
+
+		GLStateCache::Get().VertexAttribIPointer(MESH_INSTANCE_PALETTE_OFFSET_LOCATION, 1, GL_UNSIGNED_INT, stride, instanceOffset + offsetof(MeshInstance, paletteOffset));
+		GLStateCache::Get().VertexAttribDivisor(MESH_INSTANCE_PALETTE_OFFSET_LOCATION, 1);
+		GLStateCache::Get().EnableVertexAttribArray(MESH_INSTANCE_PALETTE_OFFSET_LOCATION);
+	}
+
+	void MeshComponent::DisableInstanceAttributes()
+	{
+		GLStateCache::Get().DisableVertexAttribArray(MESH_INSTANCE_ANIMATION_LOCATION);
+		for (unsigned column = 0; column < 4; ++column)
+		{
+			GLStateCache::Get().DisableVertexAttribArray(MESH_INSTANCE_MODEL_LOCATION + column);
+		}
+		GLStateCache::Get().DisableVertexAttribArray(MESH_INSTANCE_PALETTE_OFFSET_LOCATION);
+	}
+
+	void MeshComponent::DrawMesh(
+		size_t meshIndex,
+		GLuint vertexArray,
+		unsigned lod,
+		GLuint g_diffuseTextureLocation,
+		GLuint g_diffuseTextureUnit,
+		GLsizei instanceCount)
+	{
+		GLStateCache::Get().BindVertexArray(vertexArray);
+
+		GLStateCache::Get().BindTexture(g_diffuseTextureUnit, GL_TEXTURE_2D, m_diffuseTextureIds[meshIndex]);
+		GLStateCache::Get().Uniform1i(g_diffuseTextureLocation, g_diffuseTextureUnit);
+
+		const std::vector<GLsizei>& lodFirstIndices = m_lodFirstIndices[meshIndex];
+		const size_t meshLod = std::min<size_t>(lod, lodFirstIndices.size() - 2);
+		const GLsizei firstIndex = lodFirstIndices[meshLod];
+		const GLsizei indexCount = lodFirstIndices[meshLod + 1] - firstIndex;
+		const size_t indexSize = m_indexTypes[meshIndex] == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+		const void* indexOffset = reinterpret_cast<const void*>(firstIndex * indexSize);
+
+		if (instanceCount == 1)
+		{
+			glDrawElements(GL_TRIANGLES, indexCount, m_indexTypes[meshIndex], indexOffset);
+		}
+		else
+		{
+			glDrawElementsInstanced(GL_TRIANGLES, indexCount, m_indexTypes[meshIndex], indexOffset, instanceCount);
+		}
 	}
 }
@@ -1,9 +1,13 @@
 #ifndef _CE_MESH_COMPONENT_H_
 #define _CE_MESH_COMPONENT_H_
 
+#include <glm/glm.hpp>
+
 #include <vector>
 
 typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+typedef int GLsizei;
 
 namespace CE
 {
@@ -11,33 +15,106 @@ namespace CE
 	typedef std::vector<Mesh> Meshes;
 	struct Texture;
 	typedef std::vector<Texture> Textures;
+	class SkinnedMeshCache;
+
+	// Constant vertex attributes that decode a mesh's positions. Meshes in
+	// the float vertex format decode with a zero minimum and a unit extent.
+	const unsigned MESH_POSITION_MIN_LOCATION = 10;
+	const unsigned MESH_POSITION_EXTENT_LOCATION = 11;
 
 	class MeshComponent
 	{
 	public:
+		// Uploads every mesh and texture once; draws only bind and issue the draw call.
 		MeshComponent(Meshes* meshes, Textures* textures);
+		~MeshComponent();
+		MeshComponent(const MeshComponent&) = delete;
+		MeshComponent& operator=(const MeshComponent&) = delete;
+
+		// Every draw takes a level of detail. Meshes with fewer levels draw
+		// their coarsest one instead.
+
+		// Draws the unskinned source vertices, for shaders that skin on their own.
+		void Draw(
+			unsigned lod,
+			GLuint g_diffuseTextureLocation,
+			GLuint g_diffuseTextureUnit);
 
+		// Draws the model-space vertices from skinnedMeshCache.
 		void Draw(
-			GLuint g_vbo,
-			GLuint g_ibo,
-			GLuint g_diffuseTextureID,
+			const SkinnedMeshCache& skinnedMeshCache,
+			unsigned lod,
+			GLuint g_diffuseTextureLocation,
+			GLuint g_diffuseTextureUnit);
+
+		// Draws instanceCount copies of the unskinned source vertices in one
+		// draw call per mesh. instanceBuffer holds a MeshInstance per instance,
+		// starting at instanceOffset.
+		void DrawInstanced(
+			GLuint instanceBuffer,
+			size_t instanceOffset,
+			GLsizei instanceCount,
+			unsigned lod,
 			GLuint g_diffuseTextureLocation,
 			GLuint g_diffuseTextureUnit);
 
+		// Levels of detail of the mesh with the most.
+		unsigned GetLodCount() const { return m_lodCount; }
+
+		const Meshes* GetMeshes() const { return m_meshes; }
+
+		// Model-space box around every mesh in every animation of the asset.
+		// Assets converted without bounds have none, and should never be culled.
+		bool HasBounds() const { return m_hasBounds; }
+		const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+		const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+
+		// Sets the position decode attributes of a mesh, before drawing its source vertices.
+		void SetPositionDecodeAttributes(size_t meshIndex) const;
+
+		// Vertex array of the source vertices and index buffer of a mesh. The
+		// vertices are Vertex1P1UV4JCompact when the asset has them, and
+		// Vertex1P1UV4J otherwise; shaders read both the same way.
+		GLuint GetVertexArray(size_t meshIndex) const { return m_vertexArrays[meshIndex]; }
+		GLuint GetIndexBuffer(size_t meshIndex) const { return m_indexBuffers[meshIndex]; }
+
 	private:
+		void InitializeBuffers();
+		void InitializeVertexAttributes(const Mesh& mesh);
+		void InitializeTextures();
+		void InitializeBounds();
+
 		void DrawMesh(
-			const Mesh& mesh,
-			GLuint g_vbo,
-			GLuint g_ibo,
-			GLuint g_diffuseTextureID,
+			size_t meshIndex,
+			GLuint vertexArray,
+			unsigned lod,
 			GLuint g_diffuseTextureLocation,
-			GLuint g_diffuseTextureUnit);
+			GLuint g_diffuseTextureUnit,
+			GLsizei instanceCount = 1);
+
+		void EnableInstanceAttributes(GLuint instanceBuffer, size_t instanceOffset);
+		void DisableInstanceAttributes();
 
 	private:
 		Meshes* m_meshes;
 		// TODO: Remove.
 		Textures* m_textures;
+
+		std::vector<GLuint> m_vertexBuffers;
+		std::vector<GLuint> m_indexBuffers;
+		std::vector<GLuint> m_vertexArrays;
+		// GL_UNSIGNED_SHORT for meshes converted with 16 bit indices.
+		std::vector<GLenum> m_indexTypes;
+		// First index of each level of detail of each mesh, followed by the
+		// index count, so level i spans [i, i + 1).
+		std::vector<std::vector<GLsizei>> m_lodFirstIndices;
+		unsigned m_lodCount;
+		std::vector<GLuint> m_diffuseTextureIds;
+
+		bool m_hasBounds;
+		glm::vec3 m_boundsMin;
+		glm::vec3 m_boundsMax;
 	};
 }
 
-#endif // _CE_MESH_COMPONENT_H_
\ No newline at end of file
+#endif // _CE_MESH_COMPONENT_H_
@@ -0,0 +1,28 @@
+#ifndef _CE_MESH_INSTANCE_H_
+#define _CE_MESH_INSTANCE_H_
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace CE
+{
+	// Per-instance vertex attributes of instanced mesh draws. Non-instanced
+	// draws set the same locations as constant vertex attributes instead.
+	struct MeshInstance
+	{
+		// Location 4: (firstFrame, frameCount, time, sampleRate) into the animation texture.
+		glm::vec4 animationInstance;
+		// Locations 5 to 8, one column each.
+		glm::mat4 model;
+		// Location 9: first joint of the instance's palette in the concatenated palettes.
+		uint32_t paletteOffset;
+		uint32_t padding[3];
+	};
+
+	const unsigned MESH_INSTANCE_ANIMATION_LOCATION = 4;
+	const unsigned MESH_INSTANCE_MODEL_LOCATION = 5;
+	const unsigned MESH_INSTANCE_PALETTE_OFFSET_LOCATION = 9;
+}
+
+#endif // _CE_MESH_INSTANCE_H_
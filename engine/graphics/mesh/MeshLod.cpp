@@ -0,0 +1,47 @@
+#include "MeshLod.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace CE
+{
+	// Fraction of a threshold the screen size has to move past it before the level changes.
+	static const float MESH_LOD_HYSTERESIS = 0.15f;
+
+	MeshLodPolicy::MeshLodPolicy()
+	{
+		// Each generated level has about half the triangles of the one before.
+		levels.push_back({ 0.4f });
+		levels.push_back({ 0.2f });
+		levels.push_back({ 0.1f });
+		levels.push_back({ 0.f });
+	}
+
+	unsigned MeshLodPolicy::SelectLod(float screenSize, unsigned currentLod, unsigned lodCount) const
+	{
+		const unsigned maxLod = std::min(lodCount, static_cast<unsigned>(levels.size())) - 1;
+		unsigned lod = std::min(currentLod, maxLod);
+
+		while (lod < maxLod && screenSize < levels[lod].minScreenSize * (1.f - MESH_LOD_HYSTERESIS))
+		{
+			++lod;
+		}
+		while (lod > 0 && screenSize > levels[lod - 1].minScreenSize * (1.f + MESH_LOD_HYSTERESIS))
+		{
+			--lod;
+		}
+
+		return lod;
+	}
+
+	float MeshLodPolicy::CalculateScreenSize(float radius, float distance, float fieldOfView)
+	{
+		// Inside the sphere it covers the whole screen.
+		if (distance <= radius)
+		{
+			return 1.f;
+		}
+
+		return radius / (distance * std::tan(fieldOfView * 0.5f));
+	}
+}
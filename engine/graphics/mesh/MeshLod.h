@@ -0,0 +1,33 @@
+#ifndef _CE_MESH_LOD_H_
+#define _CE_MESH_LOD_H_
+
+#include <vector>
+
+namespace CE
+{
+	struct MeshLodLevel
+	{
+		// Screen size, the projected bounding sphere's radius over half the
+		// screen height, above which a finer level is used.
+		float minScreenSize;
+	};
+
+	class MeshLodPolicy
+	{
+	public:
+		MeshLodPolicy();
+
+		// Starts from the character's current level, and only moves to another
+		// level once the screen size is clearly past the threshold between them,
+		// so characters near a threshold don't switch every frame.
+		unsigned SelectLod(float screenSize, unsigned currentLod, unsigned lodCount) const;
+
+		// Screen size of a sphere seen from distance, with a vertical field of view in radians.
+		static float CalculateScreenSize(float radius, float distance, float fieldOfView);
+
+	private:
+		std::vector<MeshLodLevel> levels;
+	};
+}
+
+#endif // _CE_MESH_LOD_H_
@@ -0,0 +1,166 @@
+#include "SkinnedMeshCache.h"
+
+#include "CpuSkinner.h"
+#include "Mesh.h"
+#include "MeshComponent.h"
+#include "graphics/buffer/StreamingBuffer.h"
+#include "graphics/render/GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <limits>
+
+namespace CE
+{
+	SkinnedMeshCache::SkinnedMeshCache(const MeshComponent* meshComponent)
+		: m_meshComponent(meshComponent)
+		, m_meshes(meshComponent->GetMeshes())
+		, m_skinnedFrame(std::numeric_limits<uint64_t>::max())
+	{
+		InitializeVertexBuffers();
+	}
+
+	SkinnedMeshCache::~SkinnedMeshCache()
+	{
+		GLStateCache::Get().DeleteVertexArrays((GLsizei) m_vertexArrays.size(), m_vertexArrays.data());
+		GLStateCache::Get().DeleteBuffers((GLsizei) m_vertexBuffers.size(), m_vertexBuffers.data());
+	}
+
+	void SkinnedMeshCache::InitializeVertexBuffers()
+	{
+		m_vertexBuffers.resize(m_meshes->size());
+		m_vertexArrays.resize(m_meshes->size());
+		glGenBuffers((GLsizei) m_vertexBuffers.size(), m_vertexBuffers.data());
+		glGenVertexArrays((GLsizei) m_vertexArrays.size(), m_vertexArrays.data());
+
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			GLStateCache::Get().BindVertexArray(m_vertexArrays[i]);
+
+			// GL_DYNAMIC_COPY: written by the GPU every frame, read by the GPU only.
+			GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_vertexBuffers[i]);
+			glBufferData(GL_ARRAY_BUFFER, m_meshes->at(i).GetVertexCount() * sizeof(Vertex1P1UV), NULL, GL_DYNAMIC_COPY);
+
+			GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_meshComponent->GetIndexBuffer(i));
+
+			SetVertexBuffer(i, m_vertexBuffers[i], 0);
+			GLStateCache::Get().EnableVertexAttribArray(0);
+			GLStateCache::Get().EnableVertexAttribArray(1);
+		}
+
+		GLStateCache::Get().BindVertexArray(0);
+	}
+
+	void SkinnedMeshCache::Skin(
+		uint64_t frame,
+		const GLuint (&g_skinningProgramIds)[SKINNING_INFLUENCE_RANGE_COUNT])
+	{
+		if (IsSkinned(frame))
+		{
+			return;
+		}
+
+		// Nothing is rasterized; every vertex is skinned exactly once, in order.
+		GLStateCache::Get().Enable(GL_RASTERIZER_DISCARD);
+
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			const Mesh& mesh = m_meshes->at(i);
+
+			GLStateCache::Get().BindVertexArray(m_meshComponent->GetVertexArray(i));
+			m_meshComponent->SetPositionDecodeAttributes(i);
+
+			if (mesh.m_influenceRangeCounts.size() != SKINNING_INFLUENCE_RANGE_COUNT)
+			{
+				GLStateCache::Get().UseProgram(g_skinningProgramIds[SKINNING_INFLUENCE_RANGE_COUNT - 1]);
+				SkinRange(m_vertexBuffers[i], 0, (unsigned) mesh.GetVertexCount());
+				continue;
+			}
+
+			unsigned firstVertex = 0;
+			for (unsigned range = 0; range < SKINNING_INFLUENCE_RANGE_COUNT; ++range)
+			{
+				const unsigned vertexCount = mesh.m_influenceRangeCounts[range];
+				if (vertexCount > 0)
+				{
+					GLStateCache::Get().UseProgram(g_skinningProgramIds[range]);
+					SkinRange(m_vertexBuffers[i], firstVertex, vertexCount);
+				}
+				firstVertex += vertexCount;
+			}
+		}
+
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		GLStateCache::Get().Disable(GL_RASTERIZER_DISCARD);
+
+		m_skinnedFrame = frame;
+	}
+
+	void SkinnedMeshCache::Skin(
+		uint64_t frame,
+		const glm::mat4* palette,
+		CpuSkinner& cpuSkinner,
+		StreamingBuffer& streamingBuffer)
+	{
+		if (IsSkinned(frame))
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < m_meshes->size(); ++i)
+		{
+			const Mesh& mesh = m_meshes->at(i);
+
+			void* skinnedVertices = nullptr;
+			StreamingAllocation allocation = streamingBuffer.Map(mesh.GetVertexCount() * sizeof(Vertex1P1UV), &skinnedVertices);
+			if (!allocation.IsValid())
+			{
+				// Draws last frame's vertices instead.
+				continue;
+			}
+
+			cpuSkinner.Skin(palette, mesh, static_cast<Vertex1P1UV*>(skinnedVertices));
+			streamingBuffer.Unmap();
+
+			SetVertexBuffer(i, allocation.buffer, allocation.offset);
+		}
+
+		GLStateCache::Get().BindVertexArray(0);
+
+		m_skinnedFrame = frame;
+	}
+
+	size_t SkinnedMeshCache::GetSkinnedVertexSize() const
+	{
+		size_t size = 0;
+		for (const Mesh& mesh : *m_meshes)
+		{
+			size += mesh.GetVertexCount() * sizeof(Vertex1P1UV) + StreamingBuffer::DEFAULT_ALIGNMENT - 1;
+		}
+		return size;
+	}
+
+	void SkinnedMeshCache::SkinRange(GLuint vertexBuffer, unsigned firstVertex, unsigned vertexCount)
+	{
+		glBindBufferRange(
+			GL_TRANSFORM_FEEDBACK_BUFFER,
+			0,
+			vertexBuffer,
+			firstVertex * sizeof(Vertex1P1UV),
+			vertexCount * sizeof(Vertex1P1UV));
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, firstVertex, vertexCount);
+		glEndTransformFeedback();
+	}
+
+	void SkinnedMeshCache::SetVertexBuffer(size_t meshIndex, GLuint vertexBuffer, size_t offset)
+	{
+		GLStateCache::Get().BindVertexArray(m_vertexArrays[meshIndex]);
+		GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+
+		unsigned int stride = sizeof(Vertex1P1UV);
+		GLStateCache::Get().VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, offset + offsetof(Vertex1P1UV, position));
+		GLStateCache::Get().VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, offset + offsetof(Vertex1P1UV, uv));
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef _CE_SKINNED_MESH_CACHE_H_
+#define _CE_SKINNED_MESH_CACHE_H_
+
+#include "Vertex.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+typedef unsigned int GLuint;
+
+namespace CE
+{
+	struct Mesh;
+	typedef std::vector<Mesh> Meshes;
+	class MeshComponent;
+	class CpuSkinner;
+	class StreamingBuffer;
+
+	// Number of skinning shader permutations, for 1, 2 and 4 joint influences.
+	const unsigned SKINNING_INFLUENCE_RANGE_COUNT = 3;
+
+	// Model-space Vertex1P1UV buffers for each mesh of a character, written by
+	// a transform feedback pass. Skinning happens at most once per frame, and
+	// every pass that draws the character afterwards reads the cached vertices.
+	class SkinnedMeshCache
+	{
+	public:
+		SkinnedMeshCache(const MeshComponent* meshComponent);
+		~SkinnedMeshCache();
+		SkinnedMeshCache(const SkinnedMeshCache&) = delete;
+		SkinnedMeshCache& operator=(const SkinnedMeshCache&) = delete;
+
+		bool IsSkinned(uint64_t frame) const { return m_skinnedFrame == frame; }
+
+		// Expects the palette to be bound, and each skinning program's palette
+		// sampler to point at it. Meshes that were never partitioned by joint
+		// influences are skinned entirely by the last (4 influence) program.
+		void Skin(
+			uint64_t frame,
+			const GLuint (&g_skinningProgramIds)[SKINNING_INFLUENCE_RANGE_COUNT]);
+
+		// Skins with cpuSkinner instead, straight into this frame's region of
+		// streamingBuffer, and points the vertex arrays there. palette holds
+		// the character's joints; no texture or program is touched.
+		void Skin(
+			uint64_t frame,
+			const glm::mat4* palette,
+			CpuSkinner& cpuSkinner,
+			StreamingBuffer& streamingBuffer);
+
+		// Bytes of streaming buffer the CPU skins into each frame, including
+		// the padding that aligns each mesh.
+		size_t GetSkinnedVertexSize() const;
+
+		// Vertex array of the skinned vertices, sharing the mesh's index buffer.
+		GLuint GetVertexArray(size_t meshIndex) const { return m_vertexArrays[meshIndex]; }
+
+	private:
+		void InitializeVertexBuffers();
+		void SkinRange(GLuint vertexBuffer, unsigned firstVertex, unsigned vertexCount);
+		void SetVertexBuffer(size_t meshIndex, GLuint vertexBuffer, size_t offset);
+
+		const MeshComponent* m_meshComponent;
+		const Meshes* m_meshes;
+		std::vector<GLuint> m_vertexBuffers;
+		std::vector<GLuint> m_vertexArrays;
+		uint64_t m_skinnedFrame;
+	};
+}
+
+#endif // _CE_SKINNED_MESH_CACHE_H_
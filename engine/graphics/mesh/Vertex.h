@@ -39,6 +39,17 @@ namespace CE
 			&& lhs.jointWeights[1] == rhs.jointWeights[1]
 			&& lhs.jointWeights[2] == rhs.jointWeights[2];
 	}
+
+	// Vertex1P1UV4J in 20 bytes instead of 36. Positions are unorm16 relative to
+	// the mesh bounds, UVs are half floats, and weights are unorm8. The fourth
+	// weight is still implicit, and the last position and weight are padding.
+	struct Vertex1P1UV4JCompact
+	{
+		uint16_t position[4];
+		uint16_t uv[2];
+		uint8_t jointIndices[4];
+		uint8_t jointWeights[4];
+	};
 }
 
 #endif // _CE_VERTEX_H_
@@ -0,0 +1,394 @@
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <iterator>
+
+namespace CE
+{
+	void GLStateCache::Invalidate()
+	{
+		m_programValid = false;
+		m_vertexArrayValid = false;
+		m_activeUnitValid = false;
+		m_blendFuncValid = false;
+		m_buffers.clear();
+		m_capabilities.clear();
+		m_textures.clear();
+	}
+
+	void GLStateCache::BeginFrame()
+	{
+		m_frameCounters = m_counters;
+		m_counters = GLStateCounters();
+	}
+
+	bool GLStateCache::Filter(bool redundant)
+	{
+		if (redundant)
+		{
+			++m_counters.filtered;
+		}
+		else
+		{
+			++m_counters.issued;
+		}
+		return redundant;
+	}
+
+	void GLStateCache::UseProgram(GLuint program)
+	{
+		if (Filter(m_programValid && m_program == program))
+		{
+			return;
+		}
+
+		glUseProgram(program);
+		m_programValid = true;
+		m_program = program;
+	}
+
+	void GLStateCache::Uniform1i(GLint location, GLint value)
+	{
+		// Uniforms are only tracked for a known program.
+		if (!m_programValid)
+		{
+			Filter(false);
+			glUniform1i(location, value);
+			return;
+		}
+
+		const uint64_t key = MakeKey(m_program, static_cast<uint32_t>(location));
+		auto it = m_uniforms.find(key);
+		if (Filter(it != m_uniforms.end() && it->second == value))
+		{
+			return;
+		}
+
+		glUniform1i(location, value);
+		m_uniforms[key] = value;
+	}
+
+	void GLStateCache::Enable(GLenum capability)
+	{
+		auto it = m_capabilities.find(capability);
+		if (Filter(it != m_capabilities.end() && it->second))
+		{
+			return;
+		}
+
+		glEnable(capability);
+		m_capabilities[capability] = true;
+	}
+
+	void GLStateCache::Disable(GLenum capability)
+	{
+		auto it = m_capabilities.find(capability);
+		if (Filter(it != m_capabilities.end() && !it->second))
+		{
+			return;
+		}
+
+		glDisable(capability);
+		m_capabilities[capability] = false;
+	}
+
+	void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+	{
+		if (Filter(m_blendFuncValid && m_blendSourceFactor == sourceFactor && m_blendDestinationFactor == destinationFactor))
+		{
+			return;
+		}
+
+		glBlendFunc(sourceFactor, destinationFactor);
+		m_blendFuncValid = true;
+		m_blendSourceFactor = sourceFactor;
+		m_blendDestinationFactor = destinationFactor;
+	}
+
+	void GLStateCache::BindVertexArray(GLuint vertexArray)
+	{
+		if (Filter(m_vertexArrayValid && m_vertexArray == vertexArray))
+		{
+			return;
+		}
+
+		glBindVertexArray(vertexArray);
+		m_vertexArrayValid = true;
+		m_vertexArray = vertexArray;
+	}
+
+	GLStateCache::VertexArrayState& GLStateCache::GetVertexArrayState()
+	{
+		// Without a known vertex array, state goes to a throwaway entry that is never trusted.
+		if (!m_vertexArrayValid)
+		{
+			static VertexArrayState unknown;
+			unknown = VertexArrayState();
+			return unknown;
+		}
+
+		return m_vertexArrays[m_vertexArray];
+	}
+
+	void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+	{
+		if (target == GL_ELEMENT_ARRAY_BUFFER)
+		{
+			VertexArrayState& state = GetVertexArrayState();
+			if (Filter(state.elementBufferValid && state.elementBuffer == buffer))
+			{
+				return;
+			}
+
+			glBindBuffer(target, buffer);
+			state.elementBufferValid = m_vertexArrayValid;
+			state.elementBuffer = buffer;
+			return;
+		}
+
+		auto it = m_buffers.find(target);
+		if (Filter(it != m_buffers.end() && it->second == buffer))
+		{
+			return;
+		}
+
+		glBindBuffer(target, buffer);
+		m_buffers[target] = buffer;
+	}
+
+	void GLStateCache::EnableVertexAttribArray(GLuint index)
+	{
+		VertexArrayState& state = GetVertexArrayState();
+		VertexAttribute& attribute = state.attributes[index];
+		if (Filter(m_vertexArrayValid && attribute.enabled))
+		{
+			return;
+		}
+
+		glEnableVertexAttribArray(index);
+		attribute.enabled = true;
+	}
+
+	void GLStateCache::DisableVertexAttribArray(GLuint index)
+	{
+		// A new vertex array starts with every attribute disabled.
+		VertexArrayState& state = GetVertexArrayState();
+		VertexAttribute& attribute = state.attributes[index];
+		if (Filter(m_vertexArrayValid && !attribute.enabled))
+		{
+			return;
+		}
+
+		glDisableVertexAttribArray(index);
+		attribute.enabled = false;
+	}
+
+	void GLStateCache::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset)
+	{
+		auto buffer = m_buffers.find(GL_ARRAY_BUFFER);
+		const bool bufferKnown = buffer != m_buffers.end();
+
+		VertexArrayState& state = GetVertexArrayState();
+		VertexAttribute& attribute = state.attributes[index];
+		if (Filter(m_vertexArrayValid && bufferKnown && attribute.valid && !attribute.integer
+			&& attribute.buffer == buffer->second && attribute.size == size && attribute.type == type
+			&& attribute.normalized == normalized && attribute.stride == stride && attribute.offset == offset))
+		{
+			return;
+		}
+
+		glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<void*>(offset));
+		attribute.valid = bufferKnown;
+		attribute.integer = false;
+		attribute.buffer = bufferKnown ? buffer->second : 0;
+		attribute.size = size;
+		attribute.type = type;
+		attribute.normalized = normalized;
+		attribute.stride = stride;
+		attribute.offset = offset;
+	}
+
+	void GLStateCache::VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, size_t offset)
+	{
+		auto buffer = m_buffers.find(GL_ARRAY_BUFFER);
+		const bool bufferKnown = buffer != m_buffers.end();
+
+		VertexArrayState& state = GetVertexArrayState();
+		VertexAttribute& attribute = state.attributes[index];
+		if (Filter(m_vertexArrayValid && bufferKnown && attribute.valid && attribute.integer
+			&& attribute.buffer == buffer->second && attribute.size == size && attribute.type == type
+			&& attribute.stride == stride && attribute.offset == offset))
+		{
+			return;
+		}
+
+		glVertexAttribIPointer(index, size, type, stride, reinterpret_cast<void*>(offset));
+		attribute.valid = bufferKnown;
+		attribute.integer = true;
+		attribute.buffer = bufferKnown ? buffer->second : 0;
+		attribute.size = size;
+		attribute.type = type;
+		attribute.normalized = GL_FALSE;
+		attribute.stride = stride;
+		attribute.offset = offset;
+	}
+
+	void GLStateCache::VertexAttribDivisor(GLuint index, GLuint divisor)
+	{
+		VertexArrayState& state = GetVertexArrayState();
+		VertexAttribute& attribute = state.attributes[index];
+		if (Filter(m_vertexArrayValid && attribute.divisor == divisor))
+		{
+			return;
+		}
+
+		glVertexAttribDivisor(index, divisor);
+		attribute.divisor = divisor;
+	}
+
+	void GLStateCache::ActiveTexture(GLuint unit)
+	{
+		if (Filter(m_activeUnitValid && m_activeUnit == unit))
+		{
+			return;
+		}
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		m_activeUnitValid = true;
+		m_activeUnit = unit;
+	}
+
+	void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture)
+	{
+		// Always leaves unit active, for the parameter calls that follow a bind.
+		ActiveTexture(unit);
+
+		const uint64_t key = MakeKey(unit, target);
+		auto it = m_textures.find(key);
+		if (Filter(it != m_textures.end() && it->second == texture))
+		{
+			return;
+		}
+
+		glBindTexture(target, texture);
+		m_textures[key] = texture;
+	}
+
+	GLuint GLStateCache::GetBoundTexture(GLenum target) const
+	{
+		if (!m_activeUnitValid)
+		{
+			return 0;
+		}
+
+		auto it = m_textures.find(MakeKey(m_activeUnit, target));
+		return it != m_textures.end() ? it->second : 0;
+	}
+
+	void GLStateCache::TexParameteri(GLenum target, GLenum name, GLint value)
+	{
+		// Parameters of the default texture, or of an unknown binding, are never filtered.
+		const GLuint texture = GetBoundTexture(target);
+		const uint64_t key = MakeKey(texture, name);
+		auto it = m_textureParameters.find(key);
+		if (Filter(texture != 0 && it != m_textureParameters.end() && it->second == value))
+		{
+			return;
+		}
+
+		glTexParameteri(target, name, value);
+		if (texture != 0)
+		{
+			m_textureParameters[key] = value;
+		}
+	}
+
+	void GLStateCache::TexBufferRange(GLenum internalFormat, GLuint buffer, size_t offset, size_t size)
+	{
+		const GLuint texture = GetBoundTexture(GL_TEXTURE_BUFFER);
+		auto it = m_textureBuffers.find(texture);
+		if (Filter(texture != 0 && it != m_textureBuffers.end()
+			&& it->second.internalFormat == internalFormat && it->second.buffer == buffer
+			&& it->second.offset == offset && it->second.size == size))
+		{
+			return;
+		}
+
+		if (size == 0)
+		{
+			glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+		}
+		else
+		{
+			glTexBufferRange(GL_TEXTURE_BUFFER, internalFormat, buffer, offset, size);
+		}
+
+		if (texture != 0)
+		{
+			m_textureBuffers[texture] = { internalFormat, buffer, offset, size };
+		}
+	}
+
+	void GLStateCache::DeleteTextures(GLsizei count, const GLuint* textures)
+	{
+		glDeleteTextures(count, textures);
+
+		for (GLsizei i = 0; i < count; ++i)
+		{
+			m_textureBuffers.erase(textures[i]);
+			for (auto it = m_textures.begin(); it != m_textures.end(); )
+			{
+				it = it->second == textures[i] ? m_textures.erase(it) : std::next(it);
+			}
+			for (auto it = m_textureParameters.begin(); it != m_textureParameters.end(); )
+			{
+				it = (it->first >> 32) == textures[i] ? m_textureParameters.erase(it) : std::next(it);
+			}
+		}
+	}
+
+	void GLStateCache::DeleteBuffers(GLsizei count, const GLuint* buffers)
+	{
+		glDeleteBuffers(count, buffers);
+
+		// Deleting a bound buffer unbinds it; attribute pointers into it are
+		// left to whoever reuses the vertex array.
+		for (GLsizei i = 0; i < count; ++i)
+		{
+			for (auto it = m_buffers.begin(); it != m_buffers.end(); )
+			{
+				it = it->second == buffers[i] ? m_buffers.erase(it) : std::next(it);
+			}
+			for (auto& vertexArray : m_vertexArrays)
+			{
+				if (vertexArray.second.elementBuffer == buffers[i])
+				{
+					vertexArray.second.elementBufferValid = false;
+				}
+				for (VertexAttribute& attribute : vertexArray.second.attributes)
+				{
+					if (attribute.buffer == buffers[i])
+					{
+						attribute.valid = false;
+					}
+				}
+			}
+		}
+	}
+
+	void GLStateCache::DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+	{
+		glDeleteVertexArrays(count, vertexArrays);
+
+		for (GLsizei i = 0; i < count; ++i)
+		{
+			m_vertexArrays.erase(vertexArrays[i]);
+			if (m_vertexArrayValid && m_vertexArray == vertexArrays[i])
+			{
+				// Deleting the bound vertex array binds zero.
+				m_vertexArray = 0;
+			}
+		}
+	}
+}
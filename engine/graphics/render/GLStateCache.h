@@ -0,0 +1,143 @@
+#ifndef _CE_GL_STATE_CACHE_H_
+#define _CE_GL_STATE_CACHE_H_
+
+#include "common/Singleton.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned char GLboolean;
+
+namespace CE
+{
+	struct GLStateCounters
+	{
+		// Calls that reached GL.
+		unsigned issued = 0;
+		// Calls dropped because GL was already in the requested state.
+		unsigned filtered = 0;
+	};
+
+	// Shadows the GL state the engine changes, and drops calls that would set
+	// it to what it already is. Every bind, parameter and vertex attribute
+	// change in the engine goes through here; code that bypasses it has to
+	// call Invalidate() afterwards. Only used by the thread that owns the context.
+	class GLStateCache : public Singleton<GLStateCache>
+	{
+	public:
+		// Forgets the bindings and capabilities, so the next call of each kind
+		// reaches GL. The state of objects (vertex arrays, texture parameters and
+		// uniforms) is assumed to only ever change through the cache.
+		void Invalidate();
+
+		// Starts counting a new frame. The counters of the frame before stay readable.
+		void BeginFrame();
+		const GLStateCounters& GetFrameCounters() const { return m_frameCounters; }
+
+		void UseProgram(GLuint program);
+		// Sets a uniform of the program in use.
+		void Uniform1i(GLint location, GLint value);
+
+		void Enable(GLenum capability);
+		void Disable(GLenum capability);
+		void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+		// Bindings of GL_ELEMENT_ARRAY_BUFFER are tracked per vertex array.
+		void BindVertexArray(GLuint vertexArray);
+		void BindBuffer(GLenum target, GLuint buffer);
+
+		// Vertex attribute state of the bound vertex array. Pointers are relative
+		// to the GL_ARRAY_BUFFER bound at the time of the call.
+		void EnableVertexAttribArray(GLuint index);
+		void DisableVertexAttribArray(GLuint index);
+		void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset);
+		void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, size_t offset);
+		void VertexAttribDivisor(GLuint index, GLuint divisor);
+
+		// Texture units are numbers, not GL_TEXTURE0 based enums.
+		void ActiveTexture(GLuint unit);
+		void BindTexture(GLuint unit, GLenum target, GLuint texture);
+		// Sets a parameter of the texture bound to target on the active unit.
+		void TexParameteri(GLenum target, GLenum name, GLint value);
+		// Attaches a range of buffer to the GL_TEXTURE_BUFFER bound on the active
+		// unit. A size of zero attaches the whole buffer.
+		void TexBufferRange(GLenum internalFormat, GLuint buffer, size_t offset, size_t size);
+
+		// GL reuses deleted names, so deleting through the cache forgets their state.
+		void DeleteTextures(GLsizei count, const GLuint* textures);
+		void DeleteBuffers(GLsizei count, const GLuint* buffers);
+		void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+
+	private:
+		static const unsigned MAX_VERTEX_ATTRIBUTES = 16;
+
+		struct VertexAttribute
+		{
+			bool enabled = false;
+			bool valid = false;
+			bool integer = false;
+			GLuint buffer = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			GLboolean normalized = 0;
+			GLsizei stride = 0;
+			size_t offset = 0;
+			GLuint divisor = 0;
+		};
+
+		struct VertexArrayState
+		{
+			bool elementBufferValid = false;
+			GLuint elementBuffer = 0;
+			VertexAttribute attributes[MAX_VERTEX_ATTRIBUTES];
+		};
+
+		struct TextureBufferState
+		{
+			GLenum internalFormat;
+			GLuint buffer;
+			size_t offset;
+			size_t size;
+		};
+
+		// Returns true if the call is redundant, and counts it either way.
+		bool Filter(bool redundant);
+		VertexArrayState& GetVertexArrayState();
+		GLuint GetBoundTexture(GLenum target) const;
+
+		static uint64_t MakeKey(uint32_t high, uint32_t low) { return (static_cast<uint64_t>(high) << 32) | low; }
+
+	private:
+		GLStateCounters m_counters;
+		GLStateCounters m_frameCounters;
+
+		bool m_programValid = false;
+		GLuint m_program = 0;
+		bool m_vertexArrayValid = false;
+		GLuint m_vertexArray = 0;
+		bool m_activeUnitValid = false;
+		GLuint m_activeUnit = 0;
+		bool m_blendFuncValid = false;
+		GLenum m_blendSourceFactor = 0;
+		GLenum m_blendDestinationFactor = 0;
+
+		// Keyed by target; GL_ELEMENT_ARRAY_BUFFER lives in VertexArrayState instead.
+		std::unordered_map<GLenum, GLuint> m_buffers;
+		std::unordered_map<GLenum, bool> m_capabilities;
+		std::unordered_map<GLuint, VertexArrayState> m_vertexArrays;
+		// Keyed by (unit, target).
+		std::unordered_map<uint64_t, GLuint> m_textures;
+		// Keyed by (texture, parameter name).
+		std::unordered_map<uint64_t, GLint> m_textureParameters;
+		std::unordered_map<GLuint, TextureBufferState> m_textureBuffers;
+		// Keyed by (program, location).
+		std::unordered_map<uint64_t, GLint> m_uniforms;
+	};
+}
+
+#endif // _CE_GL_STATE_CACHE_H_
@@ -0,0 +1,119 @@
+#include "GpuPassTimer.h"
+
+#include <GL/glew.h>
+
+namespace CE
+{
+	GpuPassTimer::GpuPassTimer(bool waitsOnReuse)
+		: m_waitsOnReuse(waitsOnReuse)
+		, m_recordedCount(0)
+		, m_collectedCount(0)
+	{
+		for (Frame& frame : m_frames)
+		{
+			glGenQueries(GPU_PASS_COUNT, frame.queries);
+		}
+	}
+
+	GpuPassTimer::~GpuPassTimer()
+	{
+		for (Frame& frame : m_frames)
+		{
+			glDeleteQueries(GPU_PASS_COUNT, frame.queries);
+		}
+	}
+
+	void GpuPassTimer::BeginFrame()
+	{
+		// The GPU is still on the frame whose queries are about to be reused.
+		if (m_recordedCount - m_collectedCount == GPU_PASS_TIMER_FRAME_COUNT)
+		{
+			if (m_waitsOnReuse)
+			{
+				CollectResult(m_waitedFrames, true);
+			}
+			else
+			{
+				++m_collectedCount;
+			}
+		}
+
+		Frame& frame = m_frames[m_recordedCount % GPU_PASS_TIMER_FRAME_COUNT];
+		for (bool& isPassIssued : frame.isPassIssued)
+		{
+			isPassIssued = false;
+		}
+	}
+
+	void GpuPassTimer::EndFrame()
+	{
+		++m_recordedCount;
+	}
+
+	void GpuPassTimer::BeginPass(GpuPass pass)
+	{
+		Frame& frame = m_frames[m_recordedCount % GPU_PASS_TIMER_FRAME_COUNT];
+		unsigned passIndex = static_cast<unsigned>(pass);
+		frame.isPassIssued[passIndex] = true;
+		glBeginQuery(GL_TIME_ELAPSED, frame.queries[passIndex]);
+	}
+
+	void GpuPassTimer::EndPass()
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+	}
+
+	void GpuPassTimer::CollectResults(std::vector<GpuPassTimes>& frames, bool wait)
+	{
+		// Waited frames are older than any still pending.
+		frames.insert(frames.end(), m_waitedFrames.begin(), m_waitedFrames.end());
+		m_waitedFrames.clear();
+
+		while (m_collectedCount != m_recordedCount && CollectResult(frames, wait))
+		{
+		}
+	}
+
+	bool GpuPassTimer::CollectResult(std::vector<GpuPassTimes>& frames, bool wait)
+	{
+		const Frame& frame = m_frames[m_collectedCount % GPU_PASS_TIMER_FRAME_COUNT];
+
+		// Passes finish in order, so the frame is done once its last pass is.
+		if (!wait)
+		{
+			for (unsigned pass = GPU_PASS_COUNT; pass-- > 0;)
+			{
+				if (!frame.isPassIssued[pass])
+				{
+					continue;
+				}
+
+				GLint isAvailable = GL_FALSE;
+				glGetQueryObjectiv(frame.queries[pass], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+				if (isAvailable != GL_TRUE)
+				{
+					return false;
+				}
+				break;
+			}
+		}
+
+		GpuPassTimes times = {};
+		for (unsigned pass = 0; pass < GPU_PASS_COUNT; ++pass)
+		{
+			if (!frame.isPassIssued[pass])
+			{
+				continue;
+			}
+
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(frame.queries[pass], GL_QUERY_RESULT, &nanoseconds);
+			times.passMilliseconds[pass] = nanoseconds / 1e6f;
+			times.totalMilliseconds += times.passMilliseconds[pass];
+		}
+
+		frames.push_back(times);
+		++m_collectedCount;
+		return true;
+	}
+}
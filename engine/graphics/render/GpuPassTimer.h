@@ -0,0 +1,79 @@
+#ifndef _CE_GPU_PASS_TIMER_H_
+#define _CE_GPU_PASS_TIMER_H_
+
+#include <vector>
+
+typedef unsigned int GLuint;
+
+namespace CE
+{
+	// The passes of a frame, in the order they are drawn.
+	enum class GpuPass : unsigned
+	{
+		// Opaque UI tiles, so the depth test rejects what is behind them.
+		UI_OPAQUE,
+		MESHES,
+		SKELETONS,
+		GRID,
+		// The UI tiles that are blended.
+		UI,
+		COUNT
+	};
+
+	const unsigned GPU_PASS_COUNT = static_cast<unsigned>(GpuPass::COUNT);
+
+	// Frames of queries; enough for the frames the driver queues ahead, so
+	// results are read before their queries are reused.
+	const unsigned GPU_PASS_TIMER_FRAME_COUNT = 4;
+
+	struct GpuPassTimes
+	{
+		// Zero for passes that were skipped.
+		float passMilliseconds[GPU_PASS_COUNT];
+		float totalMilliseconds;
+	};
+
+	// GPU time of each pass of a frame, from GL_TIME_ELAPSED queries. Results
+	// are only read once available, so reading them never stalls; a frame
+	// that is still in flight when its queries are reused is dropped, unless
+	// the timer waits on reuse. Dropping skews towards slow frames, so
+	// benchmarks wait instead.
+	class GpuPassTimer
+	{
+	public:
+		explicit GpuPassTimer(bool waitsOnReuse = false);
+		~GpuPassTimer();
+		GpuPassTimer(const GpuPassTimer&) = delete;
+		GpuPassTimer& operator=(const GpuPassTimer&) = delete;
+
+		void BeginFrame();
+		void EndFrame();
+
+		// Passes can't nest.
+		void BeginPass(GpuPass pass);
+		void EndPass();
+
+		// Appends the frames the GPU has finished since the last call, oldest
+		// first. With wait, also waits for the frames still in flight.
+		void CollectResults(std::vector<GpuPassTimes>& frames, bool wait = false);
+
+	private:
+		struct Frame
+		{
+			GLuint queries[GPU_PASS_COUNT];
+			bool isPassIssued[GPU_PASS_COUNT];
+		};
+
+		bool CollectResult(std::vector<GpuPassTimes>& frames, bool wait);
+
+		Frame m_frames[GPU_PASS_TIMER_FRAME_COUNT];
+		bool m_waitsOnReuse;
+		// Frames waited on by BeginFrame, until the next CollectResults.
+		std::vector<GpuPassTimes> m_waitedFrames;
+		// Frames are recorded and collected round robin.
+		unsigned m_recordedCount;
+		unsigned m_collectedCount;
+	};
+}
+
+#endif // _CE_GPU_PASS_TIMER_H_
@@ -0,0 +1,277 @@
+#include "ProgramBatch.h"
+
+#include "ProgramBinaryCache.h"
+
+#include <GL/glew.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace CE
+{
+	// Lets the driver pick the number of compiler threads.
+	static const GLuint MAX_SHADER_COMPILER_THREADS = 0xFFFFFFFF;
+
+	ProgramBatch::ProgramBatch(ProgramBinaryCache* programBinaryCache)
+		: m_programBinaryCache(programBinaryCache)
+	{
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsKHR(MAX_SHADER_COMPILER_THREADS);
+		}
+		else if (GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(MAX_SHADER_COMPILER_THREADS);
+		}
+	}
+
+	ProgramBatch::~ProgramBatch()
+	{
+		for (const Stage& stage : m_stages)
+		{
+			if (stage.shader != 0)
+			{
+				glDeleteShader(stage.shader);
+			}
+		}
+	}
+
+	unsigned ProgramBatch::AddStage(GLenum type, const char* fileName, const std::string& source, const char* defines)
+	{
+		for (unsigned i = 0; i < m_stages.size(); ++i)
+		{
+			if (m_stages[i].type == type
+				&& strcmp(m_stages[i].fileName, fileName) == 0
+				&& m_stages[i].defines == defines)
+			{
+				return i;
+			}
+		}
+
+		Stage stage;
+		stage.type = type;
+		stage.fileName = fileName;
+		stage.source = source;
+		stage.defines = defines;
+		stage.shader = 0;
+		m_stages.push_back(stage);
+		return (unsigned) m_stages.size() - 1;
+	}
+
+	unsigned ProgramBatch::AddProgram(
+		const char* vertexShaderFileName,
+		const std::string& vertexShaderSource,
+		const char* fragmentShaderFileName,
+		const std::string& fragmentShaderSource)
+	{
+		Program program;
+		program.stages.push_back(AddStage(GL_VERTEX_SHADER, vertexShaderFileName, vertexShaderSource, ""));
+		program.stages.push_back(AddStage(GL_FRAGMENT_SHADER, fragmentShaderFileName, fragmentShaderSource, ""));
+		program.key = m_programBinaryCache
+			? m_programBinaryCache->CreateKey({ vertexShaderSource.c_str(), fragmentShaderSource.c_str() })
+			: 0;
+		program.program = 0;
+		program.cached = false;
+		m_programs.push_back(program);
+		return (unsigned) m_programs.size() - 1;
+	}
+
+	unsigned ProgramBatch::AddTransformFeedbackProgram(
+		const char* vertexShaderFileName,
+		const std::string& vertexShaderSource,
+		const char* defines,
+		const char** varyings,
+		GLsizei varyingCount)
+	{
+		// The varyings are part of the binary, so they are part of the key.
+		std::string varyingNames;
+		for (GLsizei i = 0; i < varyingCount; ++i)
+		{
+			varyingNames += varyings[i];
+			varyingNames += '\n';
+		}
+
+		Program program;
+		program.stages.push_back(AddStage(GL_VERTEX_SHADER, vertexShaderFileName, vertexShaderSource, defines));
+		program.varyings.assign(varyings, varyings + varyingCount);
+		program.key = m_programBinaryCache
+			? m_programBinaryCache->CreateKey({ vertexShaderSource.c_str(), defines, varyingNames.c_str() })
+			: 0;
+		program.program = 0;
+		program.cached = false;
+		m_programs.push_back(program);
+		return (unsigned) m_programs.size() - 1;
+	}
+
+	void ProgramBatch::Submit()
+	{
+		std::vector<bool> stagesNeeded(m_stages.size(), false);
+		for (Program& program : m_programs)
+		{
+			if (m_programBinaryCache)
+			{
+				program.program = m_programBinaryCache->Load(program.key);
+				program.cached = program.program != 0;
+			}
+
+			if (!program.cached)
+			{
+				for (unsigned stage : program.stages)
+				{
+					stagesNeeded[stage] = true;
+				}
+			}
+		}
+
+		// Nothing below waits on the driver.
+		for (size_t i = 0; i < m_stages.size(); ++i)
+		{
+			if (stagesNeeded[i])
+			{
+				CompileStage(m_stages[i]);
+			}
+		}
+
+		for (Program& program : m_programs)
+		{
+			if (!program.cached)
+			{
+				LinkProgram(program);
+			}
+		}
+	}
+
+	void ProgramBatch::CompileStage(Stage& stage)
+	{
+		stage.shader = glCreateShader(stage.type);
+
+		// Defines must come after the #version line, which must be first.
+		size_t versionEnd = stage.source.find('\n') + 1;
+		std::string version = stage.source.substr(0, versionEnd);
+		std::string body = stage.source.substr(versionEnd);
+		const char* shaderSourceStrs[] = { version.c_str(), stage.defines.c_str(), body.c_str() };
+		glShaderSource(stage.shader, 3, shaderSourceStrs, NULL);
+
+		glCompileShader(stage.shader);
+	}
+
+	void ProgramBatch::LinkProgram(Program& program)
+	{
+		program.program = glCreateProgram();
+		if (m_programBinaryCache)
+		{
+			glProgramParameteri(program.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		for (unsigned stage : program.stages)
+		{
+			glAttachShader(program.program, m_stages[stage].shader);
+		}
+
+		if (!program.varyings.empty())
+		{
+			// Varyings are captured tightly packed into a single buffer, and must be declared before linking.
+			glTransformFeedbackVaryings(
+				program.program,
+				(GLsizei) program.varyings.size(),
+				program.varyings.data(),
+				GL_INTERLEAVED_ATTRIBS);
+		}
+
+		glLinkProgram(program.program);
+	}
+
+	bool ProgramBatch::Finish()
+	{
+		bool isSuccessful = true;
+
+		for (Program& program : m_programs)
+		{
+			if (program.cached)
+			{
+				continue;
+			}
+
+			GLint programSuccess = GL_TRUE;
+			glGetProgramiv(program.program, GL_LINK_STATUS, &programSuccess);
+			if (programSuccess != GL_TRUE)
+			{
+				PrintProgramLog(program);
+				glDeleteProgram(program.program);
+				program.program = 0;
+				isSuccessful = false;
+				continue;
+			}
+
+			if (m_programBinaryCache)
+			{
+				m_programBinaryCache->Store(program.key, program.program);
+			}
+		}
+
+		// Linked programs keep what they need.
+		for (Stage& stage : m_stages)
+		{
+			if (stage.shader != 0)
+			{
+				glDeleteShader(stage.shader);
+				stage.shader = 0;
+			}
+		}
+
+		return isSuccessful;
+	}
+
+	void ProgramBatch::PrintStageLog(const Stage& stage)
+	{
+		GLint maxLength = 0;
+		glGetShaderiv(stage.shader, GL_INFO_LOG_LENGTH, &maxLength);
+
+		std::vector<char> infoLog(maxLength + 1, '\0');
+
+		GLint infoLogLength = 0;
+		glGetShaderInfoLog(stage.shader, (GLsizei) infoLog.size(), &infoLogLength, infoLog.data());
+		printf("unable to compile shader %s\n", stage.fileName);
+		if (infoLogLength > 0)
+		{
+			printf("shader log:\n");
+			printf("%s\n", infoLog.data());
+		}
+	}
+
+	void ProgramBatch::PrintProgramLog(const Program& program)
+	{
+		// A stage that failed to compile is the likelier cause, and the
+		// program log usually only repeats it.
+		bool isStageFailed = false;
+		for (unsigned stage : program.stages)
+		{
+			GLint isShaderCompiled = GL_FALSE;
+			glGetShaderiv(m_stages[stage].shader, GL_COMPILE_STATUS, &isShaderCompiled);
+			if (isShaderCompiled != GL_TRUE)
+			{
+				PrintStageLog(m_stages[stage]);
+				isStageFailed = true;
+			}
+		}
+
+		if (isStageFailed)
+		{
+			return;
+		}
+
+		GLint maxLength = 0;
+		glGetProgramiv(program.program, GL_INFO_LOG_LENGTH, &maxLength);
+
+		std::vector<char> infoLog(maxLength + 1, '\0');
+
+		GLint infoLogLength = 0;
+		glGetProgramInfoLog(program.program, (GLsizei) infoLog.size(), &infoLogLength, infoLog.data());
+		printf("error linking program %d for shader %s\n", program.program, m_stages[program.stages[0]].fileName);
+		if (infoLogLength > 0)
+		{
+			printf("program log:\n");
+			printf("%s\n", infoLog.data());
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef _CE_PROGRAM_BATCH_H_
+#define _CE_PROGRAM_BATCH_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+typedef int GLsizei;
+
+namespace CE
+{
+	class ProgramBinaryCache;
+
+	// Builds a set of programs without waiting on the driver between them.
+	// Every shader is compiled and every program linked before any status is
+	// queried, so a driver with KHR_parallel_shader_compile works on all of
+	// them at once while the caller does something else. Logs are only read
+	// for programs that failed.
+	class ProgramBatch
+	{
+	public:
+		// programBinaryCache may be null.
+		ProgramBatch(ProgramBinaryCache* programBinaryCache);
+		~ProgramBatch();
+		ProgramBatch(const ProgramBatch&) = delete;
+		ProgramBatch& operator=(const ProgramBatch&) = delete;
+
+		// Each returns the index of the program in the batch. Defines are
+		// inserted after the #version line. Stages with the same file name
+		// and defines are compiled once, and shared between programs.
+		unsigned AddProgram(
+			const char* vertexShaderFileName,
+			const std::string& vertexShaderSource,
+			const char* fragmentShaderFileName,
+			const std::string& fragmentShaderSource);
+		unsigned AddTransformFeedbackProgram(
+			const char* vertexShaderFileName,
+			const std::string& vertexShaderSource,
+			const char* defines,
+			const char** varyings,
+			GLsizei varyingCount);
+
+		// Loads the cached programs, and starts compiling and linking the rest.
+		// Returns without waiting for the driver.
+		void Submit();
+
+		// Waits for every program, and stores the new ones in the cache.
+		// Returns false if any failed to compile or link.
+		bool Finish();
+
+		// Valid once finished.
+		GLuint GetProgramId(unsigned index) const { return m_programs[index].program; }
+
+	private:
+		struct Stage
+		{
+			GLenum type;
+			const char* fileName;
+			std::string source;
+			std::string defines;
+			GLuint shader;
+		};
+
+		struct Program
+		{
+			std::vector<unsigned> stages;
+			std::vector<const char*> varyings;
+			uint64_t key;
+			GLuint program;
+			bool cached;
+		};
+
+		unsigned AddStage(GLenum type, const char* fileName, const std::string& source, const char* defines);
+		void CompileStage(Stage& stage);
+		void LinkProgram(Program& program);
+		void PrintStageLog(const Stage& stage);
+		void PrintProgramLog(const Program& program);
+
+		ProgramBinaryCache* m_programBinaryCache;
+		std::vector<Stage> m_stages;
+		std::vector<Program> m_programs;
+	};
+}
+
+#endif // _CE_PROGRAM_BATCH_H_
@@ -0,0 +1,246 @@
+#include "ProgramBinaryCache.h"
+
+#include <GL/glew.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace CE
+{
+	static const uint32_t PROGRAM_BINARY_CACHE_MAGIC = 0x42504543; // "CEPB"
+	static const uint32_t PROGRAM_BINARY_CACHE_VERSION = 1;
+	// Far above any real program binary.
+	static const uint32_t MAX_PROGRAM_BINARY_SIZE = 64 * 1024 * 1024;
+
+	// FNV-1a.
+	static const uint64_t HASH_OFFSET_BASIS = 14695981039346656037ull;
+	static const uint64_t HASH_PRIME = 1099511628211ull;
+
+	static uint64_t Hash(uint64_t hash, const char* string)
+	{
+		if (string == nullptr)
+		{
+			string = "";
+		}
+
+		// Includes the terminator, so parts can't run into each other.
+		do
+		{
+			hash ^= (unsigned char) *string;
+			hash *= HASH_PRIME;
+		} while (*string++ != '\0');
+
+		return hash;
+	}
+
+	ProgramBinaryCache::ProgramBinaryCache(const char* fileName)
+		: m_fileName(fileName)
+		, m_supported(false)
+		, m_driverHash(HASH_OFFSET_BASIS)
+		, m_dirty(false)
+	{
+		// Core since 4.1, but a driver may still support no binary formats at all.
+		if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+		{
+			GLint formatCount = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+			m_supported = formatCount > 0;
+		}
+
+		if (!m_supported)
+		{
+			printf("Program binaries are not supported, shaders will always be compiled.\n");
+			return;
+		}
+
+		m_driverHash = Hash(m_driverHash, (const char*) glGetString(GL_VENDOR));
+		m_driverHash = Hash(m_driverHash, (const char*) glGetString(GL_RENDERER));
+		m_driverHash = Hash(m_driverHash, (const char*) glGetString(GL_VERSION));
+
+		Read();
+	}
+
+	void ProgramBinaryCache::Read()
+	{
+		std::ifstream stream(m_fileName, std::ios::binary | std::ios::ate);
+		if (!stream.is_open())
+		{
+			return;
+		}
+
+		const std::streamoff fileSize = stream.tellg();
+		stream.seekg(0);
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t entryCount = 0;
+		stream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+		stream.read(reinterpret_cast<char*>(&entryCount), sizeof(entryCount));
+		if (!stream || magic != PROGRAM_BINARY_CACHE_MAGIC || version != PROGRAM_BINARY_CACHE_VERSION)
+		{
+			printf("Ignoring program binary cache %s, unknown format.\n", m_fileName.c_str());
+			m_dirty = true;
+			return;
+		}
+
+		for (uint32_t i = 0; i < entryCount; ++i)
+		{
+			uint64_t key = 0;
+			uint32_t format = 0;
+			uint32_t size = 0;
+			stream.read(reinterpret_cast<char*>(&key), sizeof(key));
+			stream.read(reinterpret_cast<char*>(&format), sizeof(format));
+			stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+			if (!stream)
+			{
+				break;
+			}
+
+			// A corrupt size must not turn into a huge allocation.
+			const std::streamoff remainingSize = fileSize - stream.tellg();
+			if (size > MAX_PROGRAM_BINARY_SIZE || (std::streamoff) size > remainingSize)
+			{
+				break;
+			}
+
+			Entry& entry = m_entries[key];
+			entry.format = format;
+			entry.binary.resize(size);
+			entry.used = false;
+			stream.read(entry.binary.data(), size);
+			if (!stream)
+			{
+				m_entries.erase(key);
+				break;
+			}
+		}
+
+		if (m_entries.size() != entryCount)
+		{
+			printf("Program binary cache %s is truncated or corrupt.\n", m_fileName.c_str());
+			m_dirty = true;
+		}
+	}
+
+	uint64_t ProgramBinaryCache::CreateKey(std::initializer_list<const char*> parts) const
+	{
+		uint64_t key = m_driverHash;
+		for (const char* part : parts)
+		{
+			key = Hash(key, part);
+		}
+		return key;
+	}
+
+	GLuint ProgramBinaryCache::Load(uint64_t key)
+	{
+		if (!m_supported)
+		{
+			return 0;
+		}
+
+		auto it = m_entries.find(key);
+		if (it == m_entries.end())
+		{
+			return 0;
+		}
+
+		Entry& entry = it->second;
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, entry.format, entry.binary.data(), (GLsizei) entry.binary.size());
+
+		// A driver may reject a binary it wrote itself, for instance after an
+		// update that kept the version string. That only costs a compile.
+		GLint linkStatus = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		if (linkStatus != GL_TRUE)
+		{
+			glDeleteProgram(program);
+			m_entries.erase(it);
+			m_dirty = true;
+			// An unknown format is reported as GL_INVALID_ENUM.
+			while (glGetError() != GL_NO_ERROR)
+			{
+			}
+			return 0;
+		}
+
+		entry.used = true;
+		return program;
+	}
+
+	void ProgramBinaryCache::Store(uint64_t key, GLuint program)
+	{
+		if (!m_supported)
+		{
+			return;
+		}
+
+		GLint size = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+		if (size <= 0 || (uint32_t) size > MAX_PROGRAM_BINARY_SIZE)
+		{
+			return;
+		}
+
+		Entry& entry = m_entries[key];
+		entry.binary.resize(size);
+		GLsizei length = 0;
+		glGetProgramBinary(program, size, &length, &entry.format, entry.binary.data());
+		entry.binary.resize(length);
+		entry.used = true;
+		m_dirty = true;
+	}
+
+	void ProgramBinaryCache::Save()
+	{
+		if (!m_supported)
+		{
+			return;
+		}
+
+		uint32_t entryCount = 0;
+		for (const auto& pair : m_entries)
+		{
+			if (pair.second.used)
+			{
+				++entryCount;
+			}
+		}
+
+		if (!m_dirty && entryCount == m_entries.size())
+		{
+			return;
+		}
+
+		std::ofstream stream(m_fileName, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			printf("Unable to write program binary cache %s\n", m_fileName.c_str());
+			return;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&PROGRAM_BINARY_CACHE_MAGIC), sizeof(PROGRAM_BINARY_CACHE_MAGIC));
+		stream.write(reinterpret_cast<const char*>(&PROGRAM_BINARY_CACHE_VERSION), sizeof(PROGRAM_BINARY_CACHE_VERSION));
+		stream.write(reinterpret_cast<const char*>(&entryCount), sizeof(entryCount));
+
+		for (const auto& pair : m_entries)
+		{
+			const Entry& entry = pair.second;
+			if (!entry.used)
+			{
+				continue;
+			}
+
+			const uint32_t format = entry.format;
+			const uint32_t size = (uint32_t) entry.binary.size();
+			stream.write(reinterpret_cast<const char*>(&pair.first), sizeof(pair.first));
+			stream.write(reinterpret_cast<const char*>(&format), sizeof(format));
+			stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			stream.write(entry.binary.data(), size);
+		}
+
+		m_dirty = false;
+	}
+}
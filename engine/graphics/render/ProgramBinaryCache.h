@@ -0,0 +1,60 @@
+#ifndef _CE_PROGRAM_BINARY_CACHE_H_
+#define _CE_PROGRAM_BINARY_CACHE_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef unsigned int GLuint;
+typedef unsigned int GLenum;
+
+namespace CE
+{
+	// Linked program binaries from previous runs, stored in a single file.
+	// Programs are keyed by a hash of everything that went into them and of
+	// the driver, so an edited shader or an updated driver misses the cache
+	// and compiles again. Needs a current context.
+	class ProgramBinaryCache
+	{
+	public:
+		// Reads the binaries stored in fileName, if any.
+		ProgramBinaryCache(const char* fileName);
+		ProgramBinaryCache(const ProgramBinaryCache&) = delete;
+		ProgramBinaryCache& operator=(const ProgramBinaryCache&) = delete;
+
+		// Hashes the sources, defines and varyings of a program.
+		uint64_t CreateKey(std::initializer_list<const char*> parts) const;
+
+		// Creates the program from its stored binary, or returns 0 when there
+		// is none, or when the driver rejects it.
+		GLuint Load(uint64_t key);
+
+		// Stores the binary of a linked program. The program should have been
+		// linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+		void Store(uint64_t key, GLuint program);
+
+		// Writes the binaries used by this run back to the file. Binaries that
+		// were not loaded or stored are dropped, so stale ones do not pile up.
+		void Save();
+
+	private:
+		struct Entry
+		{
+			GLenum format;
+			std::vector<char> binary;
+			bool used;
+		};
+
+		void Read();
+
+		std::string m_fileName;
+		bool m_supported;
+		uint64_t m_driverHash;
+		std::unordered_map<uint64_t, Entry> m_entries;
+		bool m_dirty;
+	};
+}
+
+#endif // _CE_PROGRAM_BINARY_CACHE_H_
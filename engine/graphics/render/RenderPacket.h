@@ -0,0 +1,50 @@
+#ifndef _CE_RENDER_PACKET_H_
+#define _CE_RENDER_PACKET_H_
+
+#include "graphics/mesh/MeshInstance.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CE
+{
+	// What the render thread needs to know about one visible character,
+	// besides its MeshInstance.
+	struct CharacterRenderPacket
+	{
+		size_t characterIndex;
+		size_t assetIndex;
+		unsigned meshLod;
+
+		// Joints in RenderPacket::palettes, from the instance's palette offset.
+		// Zero when nothing drawn this frame needs the character's palette.
+		uint32_t paletteJointCount;
+	};
+
+	// An immutable snapshot of one simulated frame, filled by the simulation so
+	// the render thread never touches an AnimationComponent. Packets are reused
+	// from frame to frame, so their vectors keep their capacity.
+	struct RenderPacket
+	{
+		glm::mat4 projectionViewModel;
+		int renderMode;
+		bool renderMesh;
+		bool renderSkeleton;
+		bool gpuAnimation;
+		bool instancing;
+
+		// Visible characters, with characters of the same asset and mesh LOD
+		// next to each other.
+		std::vector<CharacterRenderPacket> characters;
+		// Parallel to characters, so each asset's instances upload as one range.
+		std::vector<MeshInstance> instances;
+
+		// Palettes of every visible character, back to back.
+		std::vector<glm::mat4> palettes;
+	};
+}
+
+#endif // _CE_RENDER_PACKET_H_
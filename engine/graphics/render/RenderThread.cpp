@@ -0,0 +1,104 @@
+#include "RenderThread.h"
+
+#include "common/debug/Assert.h"
+#include "common/debug/AssertThread.h"
+
+#include <SDL.h>
+
+#include <cstdio>
+
+namespace CE
+{
+	RenderThread::RenderThread(SDL_Window* window, SDL_GLContext context, RenderFunction render)
+		: window(window)
+		, context(context)
+		, render(render)
+		, simulationPacketIndex(0)
+		, renderPacketIndex(1)
+		, packetPending(false)
+		, rendering(false)
+		, stopping(false)
+	{
+
+	}
+
+	RenderThread::~RenderThread()
+	{
+		Stop();
+	}
+
+	void RenderThread::Start()
+	{
+		stopping = false;
+		thread = std::thread(&RenderThread::Run, this);
+	}
+
+	void RenderThread::Stop()
+	{
+		if (!thread.joinable())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		condition.notify_all();
+
+		thread.join();
+	}
+
+	void RenderThread::Submit()
+	{
+		CE_REQUIRE_MAIN_THREAD();
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return !packetPending && !rendering; });
+
+			std::swap(simulationPacketIndex, renderPacketIndex);
+			packetPending = true;
+		}
+		condition.notify_all();
+	}
+
+	void RenderThread::Run()
+	{
+		CE_SET_RENDER_THREAD();
+
+		if (SDL_GL_MakeCurrent(window, context) != 0)
+		{
+			printf("Render thread could not make the OpenGL context current! SDL_Error: %s\n", SDL_GetError());
+		}
+
+		while (true)
+		{
+			unsigned packetIndex;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() { return packetPending || stopping; });
+
+				if (!packetPending)
+				{
+					break;
+				}
+
+				packetIndex = renderPacketIndex;
+				packetPending = false;
+				rendering = true;
+			}
+
+			render(packets[packetIndex]);
+			SDL_GL_SwapWindow(window);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				rendering = false;
+			}
+			condition.notify_all();
+		}
+
+		SDL_GL_MakeCurrent(window, NULL);
+	}
+}
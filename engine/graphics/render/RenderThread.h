@@ -0,0 +1,63 @@
+#ifndef _CE_RENDER_THREAD_H_
+#define _CE_RENDER_THREAD_H_
+
+#include "RenderPacket.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct SDL_Window;
+typedef void* SDL_GLContext;
+
+namespace CE
+{
+	// Owns the GL context while running. The simulation fills one packet while
+	// the render thread submits the other, so simulating frame N+1 overlaps
+	// with rendering frame N.
+	class RenderThread
+	{
+	public:
+		typedef std::function<void(const RenderPacket&)> RenderFunction;
+
+		RenderThread(SDL_Window* window, SDL_GLContext context, RenderFunction render);
+		~RenderThread();
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		// The calling thread must release the context first.
+		void Start();
+
+		// Renders the last submitted packet, then releases the context so the
+		// calling thread can make it current again.
+		void Stop();
+
+		// The packet for the simulation to fill. Valid until Submit().
+		RenderPacket& GetSimulationPacket() { return packets[simulationPacketIndex]; }
+
+		// Hands the simulation packet to the render thread. Blocks while the
+		// render thread is still drawing the packet the simulation gets next.
+		void Submit();
+
+	private:
+		void Run();
+
+		SDL_Window* window;
+		SDL_GLContext context;
+		RenderFunction render;
+
+		RenderPacket packets[2];
+		unsigned simulationPacketIndex;
+		unsigned renderPacketIndex;
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool packetPending;
+		bool rendering;
+		bool stopping;
+	};
+}
+
+#endif // _CE_RENDER_THREAD_H_
@@ -0,0 +1,62 @@
+#include "UITileMap.h"
+
+#include <algorithm>
+
+namespace CE
+{
+	UITileMap::UITileMap(unsigned width, unsigned height)
+		: m_width(width)
+		, m_height(height)
+		, m_columnCount((width + UI_TILE_SIZE - 1) / UI_TILE_SIZE)
+		, m_rowCount((height + UI_TILE_SIZE - 1) / UI_TILE_SIZE)
+		, m_tiles(m_columnCount * m_rowCount, UITile::EMPTY)
+	{
+	}
+
+	void UITileMap::Classify(const char* pixels, unsigned x, unsigned y, unsigned width, unsigned height)
+	{
+		if (width == 0 || height == 0)
+		{
+			return;
+		}
+
+		const unsigned endColumn = std::min((x + width + UI_TILE_SIZE - 1) / UI_TILE_SIZE, m_columnCount);
+		const unsigned endRow = std::min((y + height + UI_TILE_SIZE - 1) / UI_TILE_SIZE, m_rowCount);
+		for (unsigned row = y / UI_TILE_SIZE; row < endRow; ++row)
+		{
+			for (unsigned column = x / UI_TILE_SIZE; column < endColumn; ++column)
+			{
+				m_tiles[row * m_columnCount + column] = ClassifyTile(pixels, column, row);
+			}
+		}
+	}
+
+	UITile UITileMap::ClassifyTile(const char* pixels, unsigned column, unsigned row) const
+	{
+		const unsigned left = column * UI_TILE_SIZE;
+		const unsigned top = row * UI_TILE_SIZE;
+		const unsigned right = std::min(left + UI_TILE_SIZE, m_width);
+		const unsigned bottom = std::min(top + UI_TILE_SIZE, m_height);
+
+		// Stops after the first row that makes the tile translucent.
+		bool isAnyVisible = false;
+		bool isAnyTransparent = false;
+		for (unsigned y = top; y < bottom; ++y)
+		{
+			// Alpha is the last byte of each BGRA pixel.
+			const unsigned char* alpha = reinterpret_cast<const unsigned char*>(pixels) + ((size_t)y * m_width + left) * 4 + 3;
+			for (unsigned x = left; x < right; ++x, alpha += 4)
+			{
+				isAnyVisible |= *alpha != 0;
+				isAnyTransparent |= *alpha != 255;
+			}
+
+			if (isAnyVisible && isAnyTransparent)
+			{
+				return UITile::TRANSLUCENT;
+			}
+		}
+
+		return isAnyVisible ? UITile::FULLY_OPAQUE : UITile::EMPTY;
+	}
+}
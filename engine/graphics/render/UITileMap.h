@@ -0,0 +1,49 @@
+#ifndef _CE_UI_TILE_MAP_H_
+#define _CE_UI_TILE_MAP_H_
+
+#include <vector>
+
+namespace CE
+{
+	enum class UITile : unsigned char
+	{
+		// Every pixel is fully transparent.
+		EMPTY,
+		// Every pixel is fully opaque.
+		FULLY_OPAQUE,
+		TRANSLUCENT
+	};
+
+	const unsigned UI_TILE_SIZE = 64;
+
+	// Square tiles of the UI, classified by the alpha of their pixels, so the
+	// compositor can skip empty tiles and draw opaque ones without blending.
+	// Tiles on the right and bottom edges are cut off by the UI's size.
+	class UITileMap
+	{
+	public:
+		// Every tile starts empty.
+		UITileMap(unsigned width, unsigned height);
+
+		// Classifies every tile that overlaps the rect again, from a BGRA
+		// image the size of the map.
+		void Classify(const char* pixels, unsigned x, unsigned y, unsigned width, unsigned height);
+
+		unsigned GetWidth() const { return m_width; }
+		unsigned GetHeight() const { return m_height; }
+		unsigned GetColumnCount() const { return m_columnCount; }
+		unsigned GetRowCount() const { return m_rowCount; }
+		UITile GetTile(unsigned column, unsigned row) const { return m_tiles[row * m_columnCount + column]; }
+
+	private:
+		UITile ClassifyTile(const char* pixels, unsigned column, unsigned row) const;
+
+		unsigned m_width;
+		unsigned m_height;
+		unsigned m_columnCount;
+		unsigned m_rowCount;
+		std::vector<UITile> m_tiles;
+	};
+}
+
+#endif // _CE_UI_TILE_MAP_H_
@@ -0,0 +1,14 @@
+#version 410
+
+uniform mat4 projectionViewModel;
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexColor;
+
+out vec3 color;
+
+void main()
+{
+	gl_Position = projectionViewModel * vec4(vertexPosition, 1.0);
+	color = vertexColor;
+}
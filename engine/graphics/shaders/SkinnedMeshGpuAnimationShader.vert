@@ -0,0 +1,66 @@
+#version 410
+
+uniform mat4 projectionViewModel;
+uniform sampler2D animationTexture;
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec2 vertexTextureCoordinate;
+layout(location = 2) in uvec4 jointIndices;
+layout(location = 3) in vec3 jointWeights;
+
+// x: first frame of the clip, y: clip frame count, z: clip time in seconds, w: sample rate.
+layout(location = 4) in vec4 animationInstance;
+layout(location = 5) in mat4 instanceModel;
+
+// Position decode, set per mesh by MeshComponent.
+layout(location = 10) in vec3 positionMin;
+layout(location = 11) in vec3 positionExtent;
+
+out vec2 textureCoordinate;
+
+vec3 DecodePosition()
+{
+	return positionMin + positionExtent * vertexPosition;
+}
+
+mat4 FetchJointTransform(in uint jointIndex, in int frame)
+{
+	return mat4(
+		texelFetch(animationTexture, ivec2(int(jointIndex) * 4, frame), 0),
+		texelFetch(animationTexture, ivec2(int(jointIndex) * 4 + 1, frame), 0),
+		texelFetch(animationTexture, ivec2(int(jointIndex) * 4 + 2, frame), 0),
+		texelFetch(animationTexture, ivec2(int(jointIndex) * 4 + 3, frame), 0));
+}
+
+vec4 WeightedPositionForJoint(in uint jointIndex, in float jointWeight, in int frame0, in int frame1, in float alpha)
+{
+	mat4 jointTransform = FetchJointTransform(jointIndex, frame0) * (1.0 - alpha)
+		+ FetchJointTransform(jointIndex, frame1) * alpha;
+	return (jointTransform * vec4(DecodePosition(), 1.0)) * jointWeight;
+}
+
+vec4 CalculateSkinnedPosition()
+{
+	int firstFrame = int(animationInstance.x);
+	int lastFrame = int(animationInstance.y) - 1;
+	float frame = animationInstance.z * animationInstance.w;
+	int frame0 = min(int(floor(frame)), lastFrame);
+	int frame1 = min(frame0 + 1, lastFrame);
+	float alpha = clamp(frame - float(frame0), 0.0, 1.0);
+	frame0 += firstFrame;
+	frame1 += firstFrame;
+
+	vec4 skinnedPosition = vec4(0.0);
+	skinnedPosition += WeightedPositionForJoint(jointIndices.x, jointWeights.x, frame0, frame1, alpha);
+	skinnedPosition += WeightedPositionForJoint(jointIndices.y, jointWeights.y, frame0, frame1, alpha);
+	skinnedPosition += WeightedPositionForJoint(jointIndices.z, jointWeights.z, frame0, frame1, alpha);
+	skinnedPosition += WeightedPositionForJoint(jointIndices.w, 1.0 - (jointWeights.x + jointWeights.y + jointWeights.z), frame0, frame1, alpha);
+	return skinnedPosition;
+}
+
+void main()
+{
+	vec4 skinnedPosition = CalculateSkinnedPosition();
+	gl_Position = projectionViewModel * instanceModel * skinnedPosition;
+	textureCoordinate = vertexTextureCoordinate;
+}
@@ -0,0 +1,58 @@
+#version 410
+
+// Skins every instance of a mesh in one instanced draw. The palettes of all
+// instances are concatenated in one texture buffer; each instance starts at
+// its own palette offset.
+
+uniform mat4 projectionViewModel;
+uniform samplerBuffer palette;
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec2 vertexTextureCoordinate;
+layout(location = 2) in uvec4 jointIndices;
+layout(location = 3) in vec3 jointWeights;
+
+layout(location = 5) in mat4 instanceModel;
+layout(location = 9) in uint paletteOffset;
+
+// Position decode, set per mesh by MeshComponent.
+layout(location = 10) in vec3 positionMin;
+layout(location = 11) in vec3 positionExtent;
+
+out vec2 textureCoordinate;
+
+vec3 DecodePosition()
+{
+	return positionMin + positionExtent * vertexPosition;
+}
+
+mat4 FetchJointTransform(in uint jointIndex)
+{
+	int texel = int(paletteOffset + jointIndex) * 4;
+	return mat4(
+		texelFetch(palette, texel),
+		texelFetch(palette, texel + 1),
+		texelFetch(palette, texel + 2),
+		texelFetch(palette, texel + 3));
+}
+
+vec4 WeightedPositionForJoint(in uint jointIndex, in float jointWeight)
+{
+	return (FetchJointTransform(jointIndex) * vec4(DecodePosition(), 1.0)) * jointWeight;
+}
+
+vec4 CalculateSkinnedPosition()
+{
+	vec4 position = vec4(0.0);
+	position += WeightedPositionForJoint(jointIndices.x, jointWeights.x);
+	position += WeightedPositionForJoint(jointIndices.y, jointWeights.y);
+	position += WeightedPositionForJoint(jointIndices.z, jointWeights.z);
+	position += WeightedPositionForJoint(jointIndices.w, 1.0 - (jointWeights.x + jointWeights.y + jointWeights.z));
+	return position;
+}
+
+void main()
+{
+	gl_Position = projectionViewModel * instanceModel * CalculateSkinnedPosition();
+	textureCoordinate = vertexTextureCoordinate;
+}
@@ -0,0 +1,74 @@
+#version 410
+
+// Skins vertices into model space for transform feedback. Nothing is rasterized.
+// Compiled once per JOINT_INFLUENCES (1, 2 or 4); each permutation only fetches
+// the joints its range of vertices uses.
+
+#ifndef JOINT_INFLUENCES
+#define JOINT_INFLUENCES 4
+#endif
+
+uniform samplerBuffer palette;
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec2 vertexTextureCoordinate;
+layout(location = 2) in uvec4 jointIndices;
+layout(location = 3) in vec3 jointWeights;
+
+// Constant per mesh. Compact vertices store positions as unorm16 within the
+// mesh bounds; float vertices use a zero minimum and a unit extent.
+layout(location = 10) in vec3 positionMin;
+layout(location = 11) in vec3 positionExtent;
+
+out vec3 skinnedPosition;
+out vec2 skinnedTextureCoordinate;
+
+vec3 DecodePosition()
+{
+	return positionMin + positionExtent * vertexPosition;
+}
+
+vec4 CalculateWeightedPosition(in mat4 jointTransform, in float jointWeight)
+{
+	return (jointTransform * vec4(DecodePosition(), 1.0)) * jointWeight;
+}
+
+mat4 FetchJointTransform(in uint jointIndex)
+{
+	return mat4(
+		texelFetch(palette, int(jointIndex) * 4),
+		texelFetch(palette, int(jointIndex) * 4 + 1),
+		texelFetch(palette, int(jointIndex) * 4 + 2),
+		texelFetch(palette, int(jointIndex) * 4 + 3));
+}
+
+vec4 WeightedPositionForJoint(in uint jointIndex, in float jointWeight)
+{
+	mat4 jointTransform = FetchJointTransform(jointIndex);
+	return CalculateWeightedPosition(jointTransform, jointWeight);
+}
+
+vec4 CalculateSkinnedPosition()
+{
+#if JOINT_INFLUENCES == 1
+	return FetchJointTransform(jointIndices.x) * vec4(DecodePosition(), 1.0);
+#elif JOINT_INFLUENCES == 2
+	vec4 position = vec4(0.0);
+	position += WeightedPositionForJoint(jointIndices.x, jointWeights.x);
+	position += WeightedPositionForJoint(jointIndices.y, 1.0 - jointWeights.x);
+	return position;
+#else
+	vec4 position = vec4(0.0);
+	position += WeightedPositionForJoint(jointIndices.x, jointWeights.x);
+	position += WeightedPositionForJoint(jointIndices.y, jointWeights.y);
+	position += WeightedPositionForJoint(jointIndices.z, jointWeights.z);
+	position += WeightedPositionForJoint(jointIndices.w, 1.0 - (jointWeights.x + jointWeights.y + jointWeights.z));
+	return position;
+#endif
+}
+
+void main()
+{
+	skinnedPosition = CalculateSkinnedPosition().xyz;
+	skinnedTextureCoordinate = vertexTextureCoordinate;
+}
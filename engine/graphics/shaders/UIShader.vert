@@ -7,6 +7,7 @@ out vec2 textureCoordinate;
 
 void main()
 {
-	gl_Position = vec4(vertexPosition, 0, 1);
+	// At the near plane, in front of everything.
+	gl_Position = vec4(vertexPosition, -1, 1);
 	textureCoordinate = vertexTextureCoordinate;
 }
@@ -18,6 +18,10 @@ namespace CE
 	struct Skeleton
 	{
 		std::vector<Joint> joints;
+		// Sphere around the vertices each joint influences, in the joint's bind
+		// space, with the center in xyz and the radius in w. A negative radius
+		// marks a joint without vertices. Empty for older assets.
+		std::vector<glm::vec4> jointBounds;
 	};
 }
 
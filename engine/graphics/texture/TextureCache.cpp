@@ -0,0 +1,69 @@
+#include "TextureCache.h"
+
+#include "Texture.h"
+#include "graphics/render/GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+
+namespace CE
+{
+	void TextureCache::Destroy()
+	{
+		for (auto it = m_textureIds.begin(); it != m_textureIds.end(); ++it)
+		{
+			GLStateCache::Get().DeleteTextures(1, &it->second);
+		}
+		m_textureIds.clear();
+	}
+
+	GLuint TextureCache::GetTextureId(const Texture* texture)
+	{
+		auto it = m_textureIds.find(texture);
+		if (it != m_textureIds.end())
+		{
+			return it->second;
+		}
+
+		GLuint textureId = CreateTexture(*texture);
+		m_textureIds[texture] = textureId;
+		return textureId;
+	}
+
+	GLuint TextureCache::CreateTexture(const Texture& texture)
+	{
+		GLStateCache& stateCache = GLStateCache::Get();
+		GLuint textureId;
+		glGenTextures(1, &textureId);
+		stateCache.BindTexture(0, GL_TEXTURE_2D, textureId);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		stateCache.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		unsigned int glChannels = texture.channels == 3 ? GL_RGB : GL_RGBA;
+
+		if (GLEW_ARB_texture_storage)
+		{
+			// Immutable storage for the full mip chain, so the driver never has to revalidate it.
+			GLsizei levels = 1;
+			for (int size = std::max(texture.width, texture.height); size > 1; size >>= 1)
+			{
+				++levels;
+			}
+
+			GLenum internalFormat = texture.channels == 3 ? GL_RGB8 : GL_RGBA8;
+			glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, texture.width, texture.height);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture.width, texture.height, glChannels, GL_UNSIGNED_BYTE, texture.data);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, glChannels, texture.width, texture.height, 0, glChannels, GL_UNSIGNED_BYTE, texture.data);
+		}
+
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		return textureId;
+	}
+}
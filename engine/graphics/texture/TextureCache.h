@@ -0,0 +1,31 @@
+#ifndef _CE_TEXTURE_CACHE_H_
+#define _CE_TEXTURE_CACHE_H_
+
+#include "common/Singleton.h"
+
+#include <unordered_map>
+
+typedef unsigned int GLuint;
+
+namespace CE
+{
+	struct Texture;
+
+	// Owns one GL texture per Texture. The first request uploads the texture and
+	// builds its mip chain; every later request just returns the same handle.
+	class TextureCache : public Singleton<TextureCache>
+	{
+	public:
+		void Destroy();
+
+		GLuint GetTextureId(const Texture* texture);
+
+	private:
+		GLuint CreateTexture(const Texture& texture);
+
+	private:
+		std::unordered_map<const Texture*, GLuint> m_textureIds;
+	};
+}
+
+#endif // _CE_TEXTURE_CACHE_H_
@@ -5,38 +5,65 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <mutex>
 #include <string>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 #include "graphics/animation/AnimationComponent.h"
+#include "graphics/animation/AnimationLod.h"
 #include "graphics/animation/AnimationManager.h"
+#include "graphics/animation/AnimationTexture.h"
+#include "graphics/mesh/CpuSkinner.h"
 #include "graphics/mesh/Mesh.h"
 #include "graphics/mesh/Vertex.h"
 #include "graphics/mesh/MeshManager.h"
 #include "graphics/mesh/MeshComponent.h"
+#include "graphics/mesh/MeshLod.h"
+#include "graphics/mesh/MeshInstance.h"
+#include "graphics/mesh/SkinnedMeshCache.h"
+#include "graphics/buffer/StreamingBuffer.h"
+#include "graphics/debug/DebugDraw.h"
+#include "graphics/render/GLStateCache.h"
+#include "graphics/render/GpuPassTimer.h"
+#include "graphics/render/ProgramBatch.h"
+#include "graphics/render/ProgramBinaryCache.h"
+#include "graphics/render/RenderThread.h"
+#include "graphics/render/UITileMap.h"
 #include "graphics/skeleton/Skeleton.h"
 #include "graphics/skeleton/SkeletonManager.h"
 #include "graphics/texture/TextureManager.h"
+#include "graphics/texture/TextureCache.h"
 #include "graphics/texture/Texture.h"
 
 #include "graphics/ceasset/input/AssetImporter.h"
 
-#include <glm/gtx/matrix_decompose.hpp>
-
 #include "core/Engine.h"
 #include "core/FpsCounter.h"
+#include "core/FrameTimeReport.h"
+#include "core/GpuTimeCounter.h"
+#include "common/debug/Assert.h"
 #include "common/debug/AssertThread.h"
 #include "core/clock/RealTimeClock.h"
 #include "core/clock/GameTimeClock.h"
 #include "event/ToggleBindPoseEvent.h"
+#include "event/ToggleGpuAnimationEvent.h"
+#include "event/ToggleInstancingEvent.h"
 #include "event/SetRenderModeEvent.h"
 #include "core/Camera.h"
+#include "core/Frustum.h"
 #include "event/SdlEvent.h"
 #include "core/EditorCameraEventHandler.h"
 
 #include "cef/CefMain.h"
+#include "cef/browser/UIFrameRateController.h"
+#include "cef/client/UIFrame.h"
 #include "event/WindowsMessageEvent.h"
 
 #ifdef __APPLE__
@@ -46,36 +73,70 @@
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 720;
 
+// Vertical field of view of the camera, in radians.
+const float CAMERA_FIELD_OF_VIEW = glm::quarter_pi<float>();
+
+// Each asset is instantiated as a crowd of CROWD_ROWS by CROWD_COLUMNS characters.
+const unsigned CROWD_ROWS = 4;
+const unsigned CROWD_COLUMNS = 6;
+const float CROWD_SPACING = 150.f;
+
+// Rate at which clips are baked into animation textures for GPU sampling.
+const float ANIMATION_TEXTURE_SAMPLE_RATE = 30.f;
+
+// Linked programs from previous runs, in the user's preference directory.
+const char* const PROGRAM_BINARY_CACHE_FILE_NAME = "ProgramBinaries.cache";
+
 SDL_Window* g_window = NULL;
 SDL_GLContext g_context;
 
 bool g_renderQuad = true;
 
-GLuint g_skinnedMeshDiffuseTextureProgramId = 0;
-GLuint g_vbo = 0;
-GLuint g_ibo = 0;
+// Only exists while InitializeOpenGL creates the programs.
+CE::ProgramBinaryCache* g_programBinaryCache = nullptr;
+
+GLuint g_skinningProgramIds[CE::SKINNING_INFLUENCE_RANGE_COUNT] = { 0, 0, 0 };
+GLuint g_meshDiffuseTextureProgramId = 0;
 GLuint g_vao = 0;
 GLuint g_tbo = 0;
 
-GLuint g_skeletonProgramId = 0;
+GLuint g_debugDrawProgramId = 0;
 GLuint g_uiProgramId = 0;
 GLuint g_gridProgramId = 0;
-GLuint g_skinnedMeshWireFrameDiffuseTextureProgramId = 0;
+GLuint g_meshWireFrameDiffuseTextureProgramId = 0;
+GLuint g_gpuAnimationDiffuseTextureProgramId = 0;
+GLuint g_gpuAnimationWireFrameDiffuseTextureProgramId = 0;
+GLuint g_instancedMeshDiffuseTextureProgramId = 0;
+GLuint g_instancedMeshWireFrameDiffuseTextureProgramId = 0;
+
+GLuint g_skinningPaletteIds[CE::SKINNING_INFLUENCE_RANGE_COUNT] = { GLuint(-1), GLuint(-1), GLuint(-1) };
 
-GLuint g_skinnedMeshDiffuseTextureProjectionViewModelMatrixId = -1;
-GLuint g_skinnedMeshDiffuseTexturePaletteId = -1;
+GLuint g_meshDiffuseTextureProjectionViewModelMatrixId = -1;
 GLuint g_paletteTextureUnit = -1;
 GLuint g_paletteGenTex = -1;
-GLuint g_skinnedMeshDiffuseTextureDiffuseTextureId = -1;
+GLuint g_meshDiffuseTextureDiffuseTextureId = -1;
 GLuint g_diffuseTextureUnit = -1;
-GLuint g_diffuseTextureID = -1;
 
-GLuint g_skeletonProjectionViewModelMatrixId = -1;
-GLuint g_skeletonPaletteId = -1;
+GLuint g_debugDrawProjectionViewModelMatrixId = -1;
 
-GLuint g_skinnedMeshWireFrameDiffuseTextureProjectionViewModelMatrixId = -1;
-GLuint g_skinnedMeshWireFrameDiffuseTexturePaletteId = -1;
-GLuint g_skinnedMeshWireFrameDiffuseTextureDiffuseTextureId = -1;
+GLuint g_meshWireFrameDiffuseTextureProjectionViewModelMatrixId = -1;
+GLuint g_meshWireFrameDiffuseTextureDiffuseTextureId = -1;
+
+GLuint g_gpuAnimationDiffuseTextureProjectionViewModelMatrixId = -1;
+GLuint g_gpuAnimationDiffuseTextureAnimationTextureId = -1;
+GLuint g_gpuAnimationDiffuseTextureDiffuseTextureId = -1;
+
+GLuint g_gpuAnimationWireFrameDiffuseTextureProjectionViewModelMatrixId = -1;
+GLuint g_gpuAnimationWireFrameDiffuseTextureAnimationTextureId = -1;
+GLuint g_gpuAnimationWireFrameDiffuseTextureDiffuseTextureId = -1;
+
+GLuint g_instancedMeshDiffuseTextureProjectionViewModelMatrixId = -1;
+GLuint g_instancedMeshDiffuseTexturePaletteId = -1;
+GLuint g_instancedMeshDiffuseTextureDiffuseTextureId = -1;
+
+GLuint g_instancedMeshWireFrameDiffuseTextureProjectionViewModelMatrixId = -1;
+GLuint g_instancedMeshWireFrameDiffuseTexturePaletteId = -1;
+GLuint g_instancedMeshWireFrameDiffuseTextureDiffuseTextureId = -1;
 
 GLuint g_gridProjectionViewModelMatrixId = -1;
 
@@ -83,6 +144,30 @@ GLuint g_uiTextureId = -1;
 GLuint g_uiTextureUnit = -1;
 GLuint g_uiTextureID = -1;
 
+// Painted regions of the UI are packed into this buffer, then streamed to
+// its texture as a pixel unpack buffer. A frame's uploads are the view, at
+// most, then the popup, which is clipped to the view.
+const size_t UI_UPLOAD_BUFFER_FRAME_SIZE = 2 * SCREEN_WIDTH * SCREEN_HEIGHT * 4;
+CE::StreamingBuffer* g_uiUploadBuffer;
+std::vector<CefRect> g_uiUploadRects;
+
+// A region of the UI texture, and where its pixels are in CEF's buffers.
+struct UIUpload
+{
+	CefRect rect;
+	// The first pixel of the region.
+	const char* pixels;
+	// Of the source buffer, in pixels.
+	int rowLength;
+};
+
+std::vector<UIUpload> g_uiUploads;
+
+// Classified from the view buffer as it is uploaded. The popup isn't
+// classified; it makes the tiles under it translucent instead.
+CE::UITileMap* g_uiTileMap;
+CefRect g_uiPopupRect;
+
 std::vector<const char*> g_assetNames = {
 	// "assets/Quarterback Pass.ceasset",
 	// "assets/Thriller Part 2.ceasset",
@@ -92,394 +177,895 @@ std::vector<const char*> g_assetNames = {
 
 CE::AssetImporter* g_assetImporter;
 
+// Per asset, loaded and uploaded once no matter how many characters use it.
+std::vector<CE::Skeleton*> g_skeletons;
+// Each asset's Skeleton::jointBounds, moved from joint space into model space
+// in the bind pose, so that the palette carries them into the current pose.
+// Empty for assets without joint bounds.
+std::vector<std::vector<glm::vec4>> g_bindPoseJointSpheres;
 std::vector<CE::MeshComponent*> g_meshComponents;
+std::vector<CE::AnimationTexture*> g_animationTextures;
+
+// Per character. Characters of the same asset are next to each other.
+std::vector<size_t> g_characterAssetIndices;
+std::vector<glm::mat4> g_characterModels;
+// Level of detail each character was last drawn at, for hysteresis.
+std::vector<unsigned> g_characterMeshLods;
 std::vector<CE::AnimationComponent*> g_animationComponents;
+std::vector<CE::SkinnedMeshCache*> g_skinnedMeshCaches;
 
-CE::CefMain* cefMain;
+// How SkinnedMeshCache skins characters that are neither instanced nor
+// animated on the GPU; those skin in their own vertex shaders. Chosen once at
+// startup: --cpu-skinning or a software renderer pick the CPU, and
+// --gpu-skinning keeps transform feedback regardless.
+enum class SkinningBackend
+{
+	TRANSFORM_FEEDBACK,
+	CPU
+};
+SkinningBackend g_skinningBackend = SkinningBackend::TRANSFORM_FEEDBACK;
+// Only exist with the CPU backend. Skinned vertices are written straight into
+// the streaming buffer, which holds every character's meshes each frame.
+CE::CpuSkinner* g_cpuSkinner = nullptr;
+CE::StreamingBuffer* g_skinnedVertexBuffer = nullptr;
+
+// Per-frame dynamic data (palettes, debug and UI geometry) is sub-allocated from here.
+const size_t STREAMING_BUFFER_FRAME_SIZE = 4 * 1024 * 1024;
+CE::StreamingBuffer* g_streamingBuffer;
+
+CE::DebugDraw* g_debugDraw;
+
+// Incremented once per Render(), so per-frame caches know when they are stale.
+uint64_t g_frameIndex = 0;
+
+// Owns the GL context between Initialize() and Destroy().
+CE::RenderThread* g_renderThread;
+
+// Null in headless runs, which have no UI.
+CE::CefMain* cefMain = nullptr;
+// Set with --ui-frame-rate, --ui-idle-frame-rate and --ui-idle-frames.
+UIFrameRateSettings g_uiFrameRateSettings;
+
+// Headless runs have no visible window and no CEF. They simulate
+// g_benchmarkFrameCount frames with a fixed timestep, then write frame time
+// statistics to g_benchmarkReportFileName. The hidden window still needs a
+// display; the report's videoDriver says which one was used.
+bool g_headless = false;
+unsigned g_benchmarkFrameCount = 1000;
+const char* g_benchmarkReportFileName = "benchmark.json";
+const float BENCHMARK_TIMESTEP_SECONDS = 1.f / 60.f;
+// Frames left out of the statistics, while caches and the driver warm up.
+const unsigned BENCHMARK_WARMUP_FRAMES = 60;
+std::string g_rendererName;
+std::string g_videoDriverName;
+
+// Only recorded in headless runs, by the render thread, and read once it has stopped.
+std::vector<float> g_renderCpuMilliseconds;
+// GL state calls of each timed frame, as counted by GLStateCache.
+std::vector<float> g_benchmarkGlCallsIssued;
+std::vector<float> g_benchmarkGlCallsFiltered;
+std::vector<CE::GpuPassTimes> g_benchmarkGpuPassTimes;
+
+// Owned by the render thread, which hands the latest finished frame to the
+// main thread for g_gpuTimeCounter.
+CE::GpuPassTimer* g_gpuPassTimer = nullptr;
+std::vector<CE::GpuPassTimes> g_collectedGpuPassTimes;
+std::mutex g_latestGpuPassTimesMutex;
+CE::GpuPassTimes g_latestGpuPassTimes;
+bool g_hasLatestGpuPassTimes = false;
 
 EventSystem* eventSystem;
 CE::Engine* engine;
 
 CE::FpsCounter* g_fpsCounter;
+CE::GpuTimeCounter* g_gpuTimeCounter;
 
 CE::Camera* g_camera;
 
-void PrintProgramLog(GLuint program)
+CE::AnimationLodPolicy g_animationLodPolicy;
+CE::MeshLodPolicy g_meshLodPolicy;
+
+float TicksToMilliseconds(uint64_t ticks)
 {
-	if (!glIsProgram(program))
+	return (float) (ticks * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+void SkinMesh(
+	const glm::mat4* palette,
+	size_t jointCount,
+	CE::SkinnedMeshCache& skinnedMeshCache)
+{
+	if (skinnedMeshCache.IsSkinned(g_frameIndex))
 	{
-		printf("GLuint %d is not a program\n", program);
 		return;
 	}
 
-	GLint maxLength = 0;
-	glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
-
-	char* infoLog = new char[maxLength];
-
-	GLint infoLogLength = 0;
-	glGetProgramInfoLog(program, maxLength, &infoLogLength, infoLog);
-	if (infoLogLength > 0)
+	if (g_skinningBackend == SkinningBackend::CPU)
 	{
-		printf("program log:\n");
-		printf("%s\n", infoLog);
+		skinnedMeshCache.Skin(g_frameIndex, palette, *g_cpuSkinner, *g_skinnedVertexBuffer);
+		return;
 	}
 
-	delete[] infoLog;
+	// Every permutation's palette sampler already points at g_paletteTextureUnit.
+	const unsigned lastRange = CE::SKINNING_INFLUENCE_RANGE_COUNT - 1;
+	CE::GLStateCache::Get().UseProgram(g_skinningProgramIds[lastRange]);
+
+	CE::AnimationComponent::BindMatrixPalette(
+		palette,
+		jointCount,
+		g_paletteTextureUnit,
+		g_paletteGenTex,
+		g_tbo,
+		g_skinningPaletteIds[lastRange],
+		*g_streamingBuffer);
+
+	skinnedMeshCache.Skin(g_frameIndex, g_skinningProgramIds);
 }
 
-void PrintShaderLog(GLuint shader)
+// Instance attributes of a character drawn on its own.
+void SetConstantInstanceAttributes(const CE::MeshInstance& instance)
 {
-	if (!glIsShader(shader))
+	glVertexAttrib4fv(CE::MESH_INSTANCE_ANIMATION_LOCATION, &instance.animationInstance[0]);
+	for (unsigned column = 0; column < 4; ++column)
 	{
-		printf("GLuint %d is not a shader\n", shader);
-		return;
+		glVertexAttrib4fv(CE::MESH_INSTANCE_MODEL_LOCATION + column, &instance.model[column][0]);
 	}
+	glVertexAttribI4ui(CE::MESH_INSTANCE_PALETTE_OFFSET_LOCATION, instance.paletteOffset, 0, 0, 0);
+}
 
-	GLint maxLength = 0;
-	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+void RenderMesh(
+	const CE::RenderPacket& packet,
+	size_t packetIndex)
+{
+	const CE::CharacterRenderPacket& character = packet.characters[packetIndex];
+	const CE::MeshInstance& instance = packet.instances[packetIndex];
+	CE::MeshComponent& meshComponent = *g_meshComponents[character.assetIndex];
+	const CE::AnimationTexture& animationTexture = *g_animationTextures[character.assetIndex];
+	CE::SkinnedMeshCache& skinnedMeshCache = *g_skinnedMeshCaches[character.characterIndex];
+
+	bool renderWireFrameOnly = packet.renderMode == 3;
+	bool gpuAnimation = packet.gpuAnimation;
+	GLuint activeProgramID = -1;
+	GLuint activeProjectionViewModelMatrixID = -1;
+	GLuint activeAnimationTextureLocation = -1;
+	GLuint activeDiffuseTextureLocation = -1;
 
-	char* infoLog = new char[maxLength];
+	if (gpuAnimation && renderWireFrameOnly)
+	{
+		activeProgramID = g_gpuAnimationWireFrameDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_gpuAnimationWireFrameDiffuseTextureProjectionViewModelMatrixId;
+		activeAnimationTextureLocation = g_gpuAnimationWireFrameDiffuseTextureAnimationTextureId;
+		activeDiffuseTextureLocation = g_gpuAnimationWireFrameDiffuseTextureDiffuseTextureId;
+	}
+	else if (gpuAnimation)
+	{
+		activeProgramID = g_gpuAnimationDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_gpuAnimationDiffuseTextureProjectionViewModelMatrixId;
+		activeAnimationTextureLocation = g_gpuAnimationDiffuseTextureAnimationTextureId;
+		activeDiffuseTextureLocation = g_gpuAnimationDiffuseTextureDiffuseTextureId;
+	}
+	else if (renderWireFrameOnly)
+	{
+		activeProgramID = g_meshWireFrameDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_meshWireFrameDiffuseTextureProjectionViewModelMatrixId;
+		activeDiffuseTextureLocation = g_meshWireFrameDiffuseTextureDiffuseTextureId;
+	}
+	else
+	{
+		activeProgramID = g_meshDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_meshDiffuseTextureProjectionViewModelMatrixId;
+		activeDiffuseTextureLocation = g_meshDiffuseTextureDiffuseTextureId;
+	}
 
-	GLint infoLogLength = 0;
-	glGetShaderInfoLog(shader, maxLength, &infoLogLength, infoLog);
-	if (infoLogLength > 0)
+	if (!gpuAnimation)
 	{
-		printf("shader log:\n");
-		printf("%s\n", infoLog);
+		SkinMesh(packet.palettes.data() + instance.paletteOffset, character.paletteJointCount, skinnedMeshCache);
 	}
 
-	delete[] infoLog;
+	CE::GLStateCache::Get().UseProgram(activeProgramID);
+
+	glUniformMatrix4fv(activeProjectionViewModelMatrixID, 1, GL_FALSE, &packet.projectionViewModel[0][0]);
+
+	SetConstantInstanceAttributes(instance);
+
+	if (gpuAnimation)
+	{
+		// The animation texture shares the palette's texture unit; only one is used per draw.
+		animationTexture.Bind(g_paletteTextureUnit, activeAnimationTextureLocation);
+
+		meshComponent.Draw(
+			character.meshLod,
+			activeDiffuseTextureLocation,
+			g_diffuseTextureUnit);
+	}
+	else
+	{
+		// Already skinned this frame; any further pass over this character reads the same vertices.
+		meshComponent.Draw(
+			skinnedMeshCache,
+			character.meshLod,
+			activeDiffuseTextureLocation,
+			g_diffuseTextureUnit);
+	}
 }
 
-void RenderMesh(CE::MeshComponent& meshComponent, CE::AnimationComponent& animationComponent, const glm::mat4& projectionViewModel)
+// One draw call per mesh of each asset, however many characters use it.
+void RenderMeshesInstanced(const CE::RenderPacket& packet)
 {
-	bool renderWireFrameOnly = engine->GetRenderMode() == 3;
+	if (packet.characters.empty())
+	{
+		return;
+	}
+
+	bool renderWireFrameOnly = packet.renderMode == 3;
+	bool gpuAnimation = packet.gpuAnimation;
 	GLuint activeProgramID = -1;
 	GLuint activeProjectionViewModelMatrixID = -1;
-	GLuint activePaletteID = -1;
+	GLuint activeAnimationTextureLocation = -1;
+	GLuint activePaletteLocation = -1;
 	GLuint activeDiffuseTextureLocation = -1;
 
-	if (renderWireFrameOnly)
+	if (gpuAnimation && renderWireFrameOnly)
+	{
+		activeProgramID = g_gpuAnimationWireFrameDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_gpuAnimationWireFrameDiffuseTextureProjectionViewModelMatrixId;
+		activeAnimationTextureLocation = g_gpuAnimationWireFrameDiffuseTextureAnimationTextureId;
+		activeDiffuseTextureLocation = g_gpuAnimationWireFrameDiffuseTextureDiffuseTextureId;
+	}
+	else if (gpuAnimation)
+	{
+		activeProgramID = g_gpuAnimationDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_gpuAnimationDiffuseTextureProjectionViewModelMatrixId;
+		activeAnimationTextureLocation = g_gpuAnimationDiffuseTextureAnimationTextureId;
+		activeDiffuseTextureLocation = g_gpuAnimationDiffuseTextureDiffuseTextureId;
+	}
+	else if (renderWireFrameOnly)
 	{
-		activeProgramID = g_skinnedMeshWireFrameDiffuseTextureProgramId;
-		activeProjectionViewModelMatrixID = g_skinnedMeshWireFrameDiffuseTextureProjectionViewModelMatrixId;
-		activePaletteID = g_skinnedMeshWireFrameDiffuseTexturePaletteId;
-		activeDiffuseTextureLocation = g_skinnedMeshWireFrameDiffuseTextureDiffuseTextureId;
+		activeProgramID = g_instancedMeshWireFrameDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_instancedMeshWireFrameDiffuseTextureProjectionViewModelMatrixId;
+		activePaletteLocation = g_instancedMeshWireFrameDiffuseTexturePaletteId;
+		activeDiffuseTextureLocation = g_instancedMeshWireFrameDiffuseTextureDiffuseTextureId;
 	}
 	else
 	{
-		activeProgramID = g_skinnedMeshDiffuseTextureProgramId;
-		activeProjectionViewModelMatrixID = g_skinnedMeshDiffuseTextureProjectionViewModelMatrixId;
-		activePaletteID = g_skinnedMeshDiffuseTexturePaletteId;
-		activeDiffuseTextureLocation = g_skinnedMeshDiffuseTextureDiffuseTextureId;
+		activeProgramID = g_instancedMeshDiffuseTextureProgramId;
+		activeProjectionViewModelMatrixID = g_instancedMeshDiffuseTextureProjectionViewModelMatrixId;
+		activePaletteLocation = g_instancedMeshDiffuseTexturePaletteId;
+		activeDiffuseTextureLocation = g_instancedMeshDiffuseTextureDiffuseTextureId;
 	}
 
-	glUseProgram(activeProgramID);
+	CE::GLStateCache::Get().UseProgram(activeProgramID);
 
-	unsigned int stride = sizeof(CE::Vertex1P1UV4J);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(CE::Vertex1P1UV4J, position)));
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(CE::Vertex1P1UV4J, uv)));
-	glVertexAttribIPointer(2, 4, GL_UNSIGNED_BYTE, stride, reinterpret_cast<void*>(offsetof(CE::Vertex1P1UV4J, jointIndices)));
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(CE::Vertex1P1UV4J, jointWeights)));
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glEnableVertexAttribArray(3);
+	glUniformMatrix4fv(activeProjectionViewModelMatrixID, 1, GL_FALSE, &packet.projectionViewModel[0][0]);
 
-	glUniformMatrix4fv(activeProjectionViewModelMatrixID, 1, GL_FALSE, &projectionViewModel[0][0]);
-
-	if (engine->IsRenderBindPose())
+	if (!gpuAnimation)
 	{
-		animationComponent.ResetMatrixPalette();
+		// Every character's palette in one texture buffer, indexed by the instance's palette offset.
+		CE::AnimationComponent::BindMatrixPalette(
+			packet.palettes.data(),
+			packet.palettes.size(),
+			g_paletteTextureUnit,
+			g_paletteGenTex,
+			g_tbo,
+			activePaletteLocation,
+			*g_streamingBuffer);
 	}
 
-	animationComponent.BindMatrixPalette(
-		g_paletteTextureUnit,
-		g_paletteGenTex,
-		g_tbo,
-		activePaletteID);
+	CE::StreamingAllocation instances = g_streamingBuffer->Allocate(packet.instances);
+	if (!instances.IsValid())
+	{
+		return;
+	}
 
-	if (engine->GetRenderMode() == 0 || engine->GetRenderMode() == 2 || renderWireFrameOnly)
+	size_t firstInstance = 0;
+	while (firstInstance < packet.characters.size())
 	{
-		meshComponent.Draw(
-			g_vbo,
-			g_ibo,
-			g_diffuseTextureID,
+		const size_t assetIndex = packet.characters[firstInstance].assetIndex;
+		const unsigned meshLod = packet.characters[firstInstance].meshLod;
+		size_t endInstance = firstInstance + 1;
+		while (endInstance < packet.characters.size()
+			&& packet.characters[endInstance].assetIndex == assetIndex
+			&& packet.characters[endInstance].meshLod == meshLod)
+		{
+			++endInstance;
+		}
+
+		if (gpuAnimation)
+		{
+			g_animationTextures[assetIndex]->Bind(g_paletteTextureUnit, activeAnimationTextureLocation);
+		}
+
+		g_meshComponents[assetIndex]->DrawInstanced(
+			instances.buffer,
+			instances.offset + firstInstance * sizeof(CE::MeshInstance),
+			(GLsizei) (endInstance - firstInstance),
+			meshLod,
 			activeDiffuseTextureLocation,
 			g_diffuseTextureUnit);
+
+		firstInstance = endInstance;
 	}
+}
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
-	glDisableVertexAttribArray(3);
+void RenderSkeleton(const CE::Skeleton& skeleton, const glm::mat4* palette, const glm::mat4& model)
+{
+	g_debugDraw->AddSkeleton(skeleton, palette, model);
 }
 
-void RenderSkeleton(CE::AnimationComponent& animationComponent, const glm::mat4& projectionViewModel)
+void RenderGrid(const glm::mat4& projectionViewModel)
 {
-	glUseProgram(g_skeletonProgramId);
+	CE::GLStateCache::Get().UseProgram(g_gridProgramId);
+	g_debugDraw->DrawGrid(g_gridProjectionViewModelMatrixId, projectionViewModel);
+}
 
-	struct DebugSkeletonVertex
+void PackUIUpload(const UIUpload& upload, char* destination)
+{
+	const size_t rowSize = (size_t)upload.rect.width * 4;
+	for (int row = 0; row < upload.rect.height; ++row)
 	{
-		glm::vec3 position;
-		glm::vec3 color;
-		unsigned jointIndex;
-	};
-
-	unsigned stride = sizeof(DebugSkeletonVertex);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(DebugSkeletonVertex, position)));
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(DebugSkeletonVertex, color)));
-	glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, stride, reinterpret_cast<void*>(offsetof(DebugSkeletonVertex, jointIndex)));
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-
-	glUniformMatrix4fv(g_skeletonProjectionViewModelMatrixId, 1, GL_FALSE, &projectionViewModel[0][0]);
+		memcpy(destination + row * rowSize, upload.pixels + (size_t)row * upload.rowLength * 4, rowSize);
+	}
+}
 
-	if (engine->IsRenderBindPose())
+// Uploads only what CEF painted since the last frame taken, if anything, and
+// classifies the tiles it touched. The rows are packed straight into the
+// streaming buffer, and the GPU copies them later, so this thread doesn't
+// wait on the copy.
+void UploadUITexture()
+{
+	if (cefMain == nullptr)
 	{
-		animationComponent.ResetMatrixPalette();
+		return;
 	}
 
-	animationComponent.BindMatrixPalette(
-		g_paletteTextureUnit,
-		g_paletteGenTex,
-		g_tbo,
-		g_skeletonPaletteId);
-
-	const CE::Skeleton* skeleton = animationComponent.GetSkeleton();// CE::SkeletonManager::Get().GetSkeleton(g_assetNames[i]);
-
-	std::vector<DebugSkeletonVertex> debugVertices;
-	std::vector<unsigned> debugJointIndices;
-	std::vector<unsigned> debugLineIndices;
-
-	for (unsigned i = 0; i < skeleton->joints.size(); ++i)
+	const UIFrame* frame = cefMain->TakeLatestFrame();
+	if (frame == nullptr)
 	{
-		glm::mat4 bindPose = glm::inverse(skeleton->joints[i].inverseBindPose);
+		return;
+	}
 
-		// todo: bad
-		glm::vec3 scale;
-		glm::quat orientation;
-		glm::vec3 translation;
-		glm::vec3 skew;
-		glm::vec4 perspective;
-		glm::decompose(
-			bindPose,
-			scale,
-			orientation,
-			translation,
-			skew,
-			perspective);
+	g_uiUploadRects = frame->dirtyRects;
 
-		DebugSkeletonVertex vertex;
-		vertex.position = translation;
-		vertex.color = glm::vec3(1.f, 0.f, 0.f);
-		vertex.jointIndex = i;
+	// Rects are merged as they are painted, but separate ones can still add
+	// up to more than the view.
+	size_t dirtyArea = 0;
+	for (const CefRect& rect : g_uiUploadRects)
+	{
+		dirtyArea += (size_t)rect.width * rect.height;
+	}
+	if (dirtyArea > (size_t)SCREEN_WIDTH * SCREEN_HEIGHT)
+	{
+		g_uiUploadRects.assign(1, CefRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+	}
 
-		debugVertices.push_back(vertex);
+	g_uiUploads.clear();
+	size_t uploadSize = 0;
 
-		debugJointIndices.push_back(i);
+	const char* viewBuffer = frame->viewBuffer.data();
+	for (const CefRect& rect : g_uiUploadRects)
+	{
+		const char* pixels = viewBuffer + ((size_t)rect.y * SCREEN_WIDTH + rect.x) * 4;
+		g_uiUploads.push_back({ rect, pixels, SCREEN_WIDTH });
+		uploadSize += (size_t)rect.width * rect.height * 4;
+		g_uiTileMap->Classify(viewBuffer, rect.x, rect.y, rect.width, rect.height);
+	}
 
-		if (skeleton->joints[i].parentIndex != -1)
+	// The popup goes last, since it is drawn over the view.
+	const CefRect& popupRect = frame->popupRect;
+	g_uiPopupRect.Set(0, 0, 0, 0);
+	if (!frame->popupBuffer.empty())
+	{
+		int left = std::max(popupRect.x, 0);
+		int top = std::max(popupRect.y, 0);
+		int right = std::min(popupRect.x + popupRect.width, SCREEN_WIDTH);
+		int bottom = std::min(popupRect.y + popupRect.height, SCREEN_HEIGHT);
+		if (left < right && top < bottom)
 		{
-			debugLineIndices.push_back(skeleton->joints[i].parentIndex);
-			debugLineIndices.push_back(i);
+			g_uiPopupRect.Set(left, top, right - left, bottom - top);
 		}
 	}
-
-	if (engine->GetRenderMode() == 1 || engine->GetRenderMode() == 2)
+	if (frame->isPopupDirty && !g_uiPopupRect.IsEmpty())
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, g_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(DebugSkeletonVertex) * debugVertices.size(), debugVertices.data(), GL_STATIC_DRAW);
+		const char* pixels = frame->popupBuffer.data()
+			+ ((size_t)(g_uiPopupRect.y - popupRect.y) * popupRect.width + (g_uiPopupRect.x - popupRect.x)) * 4;
+		g_uiUploads.push_back({ g_uiPopupRect, pixels, popupRect.width });
+		uploadSize += (size_t)g_uiPopupRect.width * g_uiPopupRect.height * 4;
+	}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ibo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned) * debugJointIndices.size(), debugJointIndices.data(), GL_STATIC_DRAW);
+	if (g_uiUploads.empty())
+	{
+		return;
+	}
 
-		glPointSize(5.f);
-		glDrawElements(GL_POINTS, (GLsizei)debugJointIndices.size(), GL_UNSIGNED_INT, NULL);
+	CE::GLStateCache::Get().BindTexture(g_uiTextureUnit, GL_TEXTURE_2D, g_uiTextureID);
 
-		for (unsigned i = 0; i < skeleton->joints.size(); ++i)
+	void* mappedData = nullptr;
+	CE::StreamingAllocation pixels = g_uiUploadBuffer->Map(uploadSize, &mappedData);
+	if (!pixels.IsValid())
+	{
+		// The frame stays valid until the next one is taken, so its regions
+		// can still be copied synchronously, rather than be lost.
+		for (const UIUpload& upload : g_uiUploads)
 		{
-			debugVertices[i].color = glm::vec3(1.f, 1.f, 0.f);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, upload.rowLength);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, upload.rect.x, upload.rect.y, upload.rect.width, upload.rect.height, GL_BGRA, GL_UNSIGNED_BYTE, upload.pixels);
 		}
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		return;
+	}
+
+	size_t offset = 0;
+	for (const UIUpload& upload : g_uiUploads)
+	{
+		PackUIUpload(upload, static_cast<char*>(mappedData) + offset);
+		offset += (size_t)upload.rect.width * upload.rect.height * 4;
+	}
+	g_uiUploadBuffer->Unmap();
 
-		glBufferData(GL_ARRAY_BUFFER, sizeof(DebugSkeletonVertex) * debugVertices.size(), debugVertices.data(), GL_STATIC_DRAW);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned) * debugLineIndices.size(), debugLineIndices.data(), GL_STATIC_DRAW);
+	CE::GLStateCache::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, pixels.buffer);
+	offset = pixels.offset;
+	for (const UIUpload& upload : g_uiUploads)
+	{
+		const CefRect& rect = upload.rect;
+		glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, GL_BGRA, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(offset));
+		offset += (size_t)rect.width * rect.height * 4;
+	}
+	// Other texture uploads read from client memory.
+	CE::GLStateCache::Get().BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
 
-		glLineWidth(1.f);
-		glDrawElements(GL_LINES, (GLsizei)debugLineIndices.size(), GL_UNSIGNED_INT, NULL);
+CE::UITile GetUITile(unsigned column, unsigned row)
+{
+	CE::UITile tile = g_uiTileMap->GetTile(column, row);
+	if (g_uiPopupRect.IsEmpty())
+	{
+		return tile;
 	}
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-	glDisableVertexAttribArray(2);
+	const int left = column * CE::UI_TILE_SIZE;
+	const int top = row * CE::UI_TILE_SIZE;
+	const bool isUnderPopup = left < g_uiPopupRect.x + g_uiPopupRect.width && g_uiPopupRect.x < left + (int)CE::UI_TILE_SIZE
+		&& top < g_uiPopupRect.y + g_uiPopupRect.height && g_uiPopupRect.y < top + (int)CE::UI_TILE_SIZE;
+	return isUnderPopup ? CE::UITile::TRANSLUCENT : tile;
 }
 
-void RenderGrid(const glm::mat4& projectionViewModel)
+// Draws the UI tiles of one kind, as quads at the near plane. Consecutive
+// tiles of a row are merged into one quad.
+void RenderUITiles(CE::UITile kind)
 {
-	glUseProgram(g_gridProgramId);
+	if (cefMain == nullptr)
+	{
+		return;
+	}
 
-	struct GridVertex
+	struct UIVertex
 	{
-		glm::vec3 position;
-		// color is hardcoded in GridShader.frag
+		glm::vec2 position;
+		float uv[2];
 	};
 
-	unsigned stride = sizeof(GridVertex);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(GridVertex, position)));
-	glEnableVertexAttribArray(0);
+	std::vector<UIVertex> uiVertices;
+	std::vector<unsigned> uiIndices;
+
+	const unsigned columnCount = g_uiTileMap->GetColumnCount();
+	for (unsigned row = 0; row < g_uiTileMap->GetRowCount(); ++row)
+	{
+		for (unsigned column = 0; column < columnCount;)
+		{
+			if (GetUITile(column, row) != kind)
+			{
+				++column;
+				continue;
+			}
 
-	glUniformMatrix4fv(g_gridProjectionViewModelMatrixId, 1, GL_FALSE, &projectionViewModel[0][0]);
+			unsigned endColumn = column + 1;
+			while (endColumn < columnCount && GetUITile(endColumn, row) == kind)
+			{
+				++endColumn;
+			}
 
-	std::vector<GridVertex> gridVertices;
-	std::vector<unsigned> gridIndices;
+			// Texture coordinates have an upper-left origin, like CEF's buffers.
+			float left = (float)(column * CE::UI_TILE_SIZE) / SCREEN_WIDTH;
+			float right = (float)std::min<unsigned>(endColumn * CE::UI_TILE_SIZE, SCREEN_WIDTH) / SCREEN_WIDTH;
+			float top = (float)(row * CE::UI_TILE_SIZE) / SCREEN_HEIGHT;
+			float bottom = (float)std::min<unsigned>((row + 1) * CE::UI_TILE_SIZE, SCREEN_HEIGHT) / SCREEN_HEIGHT;
+
+			unsigned firstVertex = (unsigned)uiVertices.size();
+			UIVertex uiVertex;
+
+			uiVertex.position = glm::vec2(left * 2.f - 1.f, 1.f - bottom * 2.f);
+			uiVertex.uv[0] = left;
+			uiVertex.uv[1] = bottom;
+			uiVertices.push_back(uiVertex);
+
+			uiVertex.position = glm::vec2(right * 2.f - 1.f, 1.f - bottom * 2.f);
+			uiVertex.uv[0] = right;
+			uiVertex.uv[1] = bottom;
+			uiVertices.push_back(uiVertex);
+
+			uiVertex.position = glm::vec2(left * 2.f - 1.f, 1.f - top * 2.f);
+			uiVertex.uv[0] = left;
+			uiVertex.uv[1] = top;
+			uiVertices.push_back(uiVertex);
+
+			uiVertex.position = glm::vec2(right * 2.f - 1.f, 1.f - top * 2.f);
+			uiVertex.uv[0] = right;
+			uiVertex.uv[1] = top;
+			uiVertices.push_back(uiVertex);
+
+			uiIndices.push_back(firstVertex + 0);
+			uiIndices.push_back(firstVertex + 1);
+			uiIndices.push_back(firstVertex + 2);
+			uiIndices.push_back(firstVertex + 1);
+			uiIndices.push_back(firstVertex + 3);
+			uiIndices.push_back(firstVertex + 2);
+
+			column = endColumn;
+		}
+	}
 
-	int sideLength = 2000;
-	int halfSideLength = sideLength / 2;
-	int increment = 100;
+	if (uiIndices.empty())
+	{
+		return;
+	}
 
-	for (int i = -halfSideLength; i <= halfSideLength; i += increment)
+	CE::StreamingAllocation vertices = g_streamingBuffer->Allocate(uiVertices);
+	CE::StreamingAllocation indices = g_streamingBuffer->Allocate(uiIndices);
+	if (!vertices.IsValid() || !indices.IsValid())
 	{
-		GridVertex gridVertexMaxZ;
-		gridVertexMaxZ.position = glm::vec3(i, 0, halfSideLength);
-		gridVertices.push_back(gridVertexMaxZ);
-		gridIndices.push_back(static_cast<unsigned>(gridIndices.size()));
+		return;
+	}
+
+	CE::GLStateCache::Get().UseProgram(g_uiProgramId);
+	CE::GLStateCache::Get().BindVertexArray(g_vao);
+
+	unsigned stride = sizeof(UIVertex);
+	CE::GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+	CE::GLStateCache::Get().VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, vertices.offset + offsetof(UIVertex, position));
+	CE::GLStateCache::Get().VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, vertices.offset + offsetof(UIVertex, uv));
+	CE::GLStateCache::Get().EnableVertexAttribArray(0);
+	CE::GLStateCache::Get().EnableVertexAttribArray(1);
 
-		GridVertex gridVertexMinZ;
-		gridVertexMinZ.position = glm::vec3(i, 0, -halfSideLength);
-		gridVertices.push_back(gridVertexMinZ);
-		gridIndices.push_back(static_cast<unsigned>(gridIndices.size()));
+	CE::GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer);
 
+	CE::GLStateCache::Get().BindTexture(g_uiTextureUnit, GL_TEXTURE_2D, g_uiTextureID);
+	CE::GLStateCache::Get().Uniform1i(g_uiTextureId, g_uiTextureUnit);
 
-		GridVertex gridVertexMaxX;
-		gridVertexMaxX.position = glm::vec3(halfSideLength, 0, i);
-		gridVertices.push_back(gridVertexMaxX);
-		gridIndices.push_back(static_cast<unsigned>(gridIndices.size()));
+	// g_vao only ever draws the UI, so its attributes stay enabled.
+	glDrawElements(GL_TRIANGLES, (GLsizei)uiIndices.size(), GL_UNSIGNED_INT, reinterpret_cast<void*>(indices.offset));
+}
+
+// The character's root joint in world space.
+glm::vec3 GetCharacterRootPosition(size_t characterIndex)
+{
+	const glm::vec3& rootPosition = g_animationComponents[characterIndex]->GetRootPosition();
+	return glm::vec3(g_characterModels[characterIndex] * glm::vec4(rootPosition, 1.f));
+}
+
+float MaxAxisScale(const glm::mat4& matrix)
+{
+	return glm::max(glm::length(glm::vec3(matrix[0])), glm::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+}
 
-		GridVertex gridVertexMinX;
-		gridVertexMinX.position = glm::vec3(-halfSideLength, 0, i);
-		gridVertices.push_back(gridVertexMinX);
-		gridIndices.push_back(static_cast<unsigned>(gridIndices.size()));
+void InitializeBindPoseJointSpheres(const CE::Skeleton& skeleton)
+{
+	std::vector<glm::vec4> spheres;
+	if (skeleton.jointBounds.size() == skeleton.joints.size())
+	{
+		spheres.reserve(skeleton.jointBounds.size());
+		for (size_t i = 0; i < skeleton.jointBounds.size(); ++i)
+		{
+			const glm::vec4& sphere = skeleton.jointBounds[i];
+			const glm::mat4 bindPose = glm::inverse(skeleton.joints[i].inverseBindPose);
+			const glm::vec3 center = glm::vec3(bindPose * glm::vec4(glm::vec3(sphere), 1.f));
+			// Joints without vertices keep their negative radius.
+			spheres.push_back(glm::vec4(center, sphere.w < 0.f ? sphere.w : sphere.w * MaxAxisScale(bindPose)));
+		}
 	}
+	g_bindPoseJointSpheres.push_back(spheres);
+}
 
-	glBindBuffer(GL_ARRAY_BUFFER, g_vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GridVertex) * gridVertices.size(), gridVertices.data(), GL_STATIC_DRAW);
+// Whether the character, in the pose of its palette, may be in the frustum.
+// Tighter than the asset's bounds, which cover every frame of every clip.
+bool IsPoseInFrustum(const CE::Frustum& frustum, size_t characterIndex, const glm::mat4* palette, size_t jointCount)
+{
+	const std::vector<glm::vec4>& spheres = g_bindPoseJointSpheres[g_characterAssetIndices[characterIndex]];
+	if (spheres.size() != jointCount)
+	{
+		return true;
+	}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned) * gridIndices.size(), gridIndices.data(), GL_STATIC_DRAW);
+	glm::vec3 boundsMin(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+	for (size_t i = 0; i < jointCount; ++i)
+	{
+		const glm::vec4& sphere = spheres[i];
+		if (sphere.w < 0.f)
+		{
+			continue;
+		}
 
-	glLineWidth(1.f);
-	glDrawElements(GL_LINES, (GLsizei)gridIndices.size(), GL_UNSIGNED_INT, NULL);
+		const glm::vec3 center = glm::vec3(palette[i] * glm::vec4(glm::vec3(sphere), 1.f));
+		const glm::vec3 radius = glm::vec3(sphere.w * MaxAxisScale(palette[i]));
+		boundsMin = glm::min(boundsMin, center - radius);
+		boundsMax = glm::max(boundsMax, center + radius);
+	}
+
+	// No joint moves any vertex.
+	if (boundsMin.x > boundsMax.x)
+	{
+		return true;
+	}
 
-	glDisableVertexAttribArray(0);
+	return frustum.IntersectsBox(boundsMin, boundsMax, g_characterModels[characterIndex]);
 }
 
-void RenderUI()
+// Picks the character's mesh level of detail from the screen size of its
+// asset's bounding sphere. Assets without bounds always draw their finest level.
+unsigned SelectMeshLod(size_t characterIndex)
 {
-	glUseProgram(g_uiProgramId);
+	const CE::MeshComponent* meshComponent = g_meshComponents[g_characterAssetIndices[characterIndex]];
+	if (!meshComponent->HasBounds())
+	{
+		return 0;
+	}
 
-	struct UIVertex
+	const glm::mat4& model = g_characterModels[characterIndex];
+	const glm::vec3 boundsCenter = (meshComponent->GetBoundsMin() + meshComponent->GetBoundsMax()) * 0.5f;
+	const glm::vec3 center = glm::vec3(model * glm::vec4(boundsCenter, 1.f));
+	const float radius = glm::length(meshComponent->GetBoundsMax() - meshComponent->GetBoundsMin()) * 0.5f * MaxAxisScale(model);
+
+	const float screenSize = CE::MeshLodPolicy::CalculateScreenSize(
+		radius,
+		glm::distance(g_camera->GetLocation(), center),
+		CAMERA_FIELD_OF_VIEW);
+
+	g_characterMeshLods[characterIndex] = g_meshLodPolicy.SelectLod(
+		screenSize,
+		g_characterMeshLods[characterIndex],
+		meshComponent->GetLodCount());
+	return g_characterMeshLods[characterIndex];
+}
+
+// Groups the packet's characters by asset, then by mesh level of detail, so
+// each group draws as one instance range. Palette offsets stay valid.
+void SortRenderPacket(CE::RenderPacket& packet)
+{
+	static std::vector<size_t> order;
+	static std::vector<CE::CharacterRenderPacket> characters;
+	static std::vector<CE::MeshInstance> instances;
+
+	order.resize(packet.characters.size());
+	for (size_t i = 0; i < order.size(); ++i)
 	{
-		glm::vec2 position;
-		float uv[2];
-	};
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&packet](size_t lhs, size_t rhs)
+	{
+		const CE::CharacterRenderPacket& lhsCharacter = packet.characters[lhs];
+		const CE::CharacterRenderPacket& rhsCharacter = packet.characters[rhs];
+		if (lhsCharacter.assetIndex != rhsCharacter.assetIndex)
+		{
+			return lhsCharacter.assetIndex < rhsCharacter.assetIndex;
+		}
+		return lhsCharacter.meshLod < rhsCharacter.meshLod;
+	});
 
-	unsigned stride = sizeof(UIVertex);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(UIVertex, position)));
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(UIVertex, uv)));
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
+	characters.clear();
+	instances.clear();
+	for (size_t i : order)
+	{
+		characters.push_back(packet.characters[i]);
+		instances.push_back(packet.instances[i]);
+	}
+	packet.characters.swap(characters);
+	packet.instances.swap(instances);
+}
 
-	std::vector<UIVertex> uiVertices;
-	UIVertex uiVertex;
+// Runs on the main thread. Everything the render thread needs from the
+// simulation is copied into the packet, including evaluated palettes.
+void BuildRenderPacket(CE::RenderPacket& packet)
+{
+	CE_REQUIRE_MAIN_THREAD();
 
-	uiVertex.position = glm::vec2(-1.f, -1.f);
-	uiVertex.uv[0] = 0.f;
-	uiVertex.uv[1] = 1.f;
-	uiVertices.push_back(uiVertex);
+	glm::mat4 projection = glm::perspective(CAMERA_FIELD_OF_VIEW, (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 10000.0f);
+	glm::mat4 view = g_camera->CreateViewMatrix();
+	glm::mat4 model = glm::mat4(1.0f);
+	packet.projectionViewModel = projection * view * model;
 
-	uiVertex.position = glm::vec2(1.f, -1.f);
-	uiVertex.uv[0] = 1.f;
-	uiVertex.uv[1] = 1.f;
-	uiVertices.push_back(uiVertex);
+	// Only issue passes that draw something, so their palettes aren't evaluated for nothing.
+	packet.renderMode = engine->GetRenderMode();
+	packet.renderMesh = packet.renderMode == 0 || packet.renderMode == 2 || packet.renderMode == 3;
+	packet.renderSkeleton = packet.renderMode == 1 || packet.renderMode == 2;
 
-	uiVertex.position = glm::vec2(-1.f, 1.f);
-	uiVertex.uv[0] = 0.f;
-	uiVertex.uv[1] = 0.f;
-	uiVertices.push_back(uiVertex);
+	bool bindPose = engine->IsRenderBindPose();
+	// The bind pose is not baked into the animation textures, so it always goes through the palette.
+	packet.gpuAnimation = engine->IsGpuAnimation() && !bindPose;
+	// Instanced draws skin in their vertex shader, so the CPU backend needs the per-character path.
+	packet.instancing = engine->IsInstancing() && g_skinningBackend != SkinningBackend::CPU;
 
-	uiVertex.position = glm::vec2(1.f, 1.f);
-	uiVertex.uv[0] = 1.f;
-	uiVertex.uv[1] = 0.f;
-	uiVertices.push_back(uiVertex);
+	bool needsPalette = (packet.renderMesh && !packet.gpuAnimation) || packet.renderSkeleton;
 
-	std::vector<unsigned> uiIndices;
-	uiIndices.push_back(0);
-	uiIndices.push_back(1);
-	uiIndices.push_back(2);
-	uiIndices.push_back(1);
-	uiIndices.push_back(3);
-	uiIndices.push_back(2);
+	CE::Frustum frustum(packet.projectionViewModel);
+
+	packet.characters.clear();
+	packet.instances.clear();
+	packet.palettes.clear();
+
+	for (size_t i = 0; i < g_animationComponents.size(); ++i)
+	{
+		// Off-screen characters never request their pose, so it is never evaluated,
+		// uploaded or drawn. The asset's bounds cover all of its animations.
+		const CE::MeshComponent* meshComponent = g_meshComponents[g_characterAssetIndices[i]];
+		if (meshComponent->HasBounds()
+			&& !frustum.IntersectsBox(meshComponent->GetBoundsMin(), meshComponent->GetBoundsMax(), g_characterModels[i]))
+		{
+			continue;
+		}
+
+		CE::AnimationComponent* animationComponent = g_animationComponents[i];
 
-	glBindBuffer(GL_ARRAY_BUFFER, g_vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(UIVertex) * uiVertices.size(), uiVertices.data(), GL_STATIC_DRAW);
+		CE::CharacterRenderPacket character;
+		character.characterIndex = i;
+		character.assetIndex = g_characterAssetIndices[i];
+		character.meshLod = SelectMeshLod(i);
+		character.paletteJointCount = 0;
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned) * uiIndices.size(), uiIndices.data(), GL_STATIC_DRAW);
+		CE::MeshInstance instance;
+		instance.animationInstance = glm::vec4(0.f);
+		instance.model = g_characterModels[i];
+		instance.paletteOffset = (uint32_t) packet.palettes.size();
 
-	// TODO: How much of this has to be done every Draw() call?
-	// TODO: double check these for UI
-	glBindTexture(GL_TEXTURE_2D, g_uiTextureID);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	const char* viewBuffer = cefMain->GetViewBuffer();
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_BGRA, GL_UNSIGNED_BYTE, viewBuffer);
-	const char* popupBuffer = cefMain->GetPopupBuffer();
-	if (popupBuffer != nullptr)
+		if (needsPalette)
+		{
+			const std::vector<glm::mat4>& palette = animationComponent->GetMatrixPalette(bindPose);
+			// The pose is evaluated anyway; culling by it spares skinning and drawing.
+			if (!IsPoseInFrustum(frustum, i, palette.data(), palette.size()))
+			{
+				continue;
+			}
+
+			packet.palettes.insert(packet.palettes.end(), palette.begin(), palette.end());
+			character.paletteJointCount = (uint32_t) palette.size();
+		}
+
+		if (packet.gpuAnimation)
+		{
+			instance.animationInstance = g_animationTextures[character.assetIndex]->CreateInstanceAttribute(
+				animationComponent->GetCurrentAnimation(),
+				animationComponent->GetCurrentTime());
+		}
+
+		packet.characters.push_back(character);
+		packet.instances.push_back(instance);
+	}
+
+	SortRenderPacket(packet);
+}
+
+// Runs on the render thread, which owns the GL context.
+void CollectGpuPassTimes(bool wait)
+{
+	g_collectedGpuPassTimes.clear();
+	g_gpuPassTimer->CollectResults(g_collectedGpuPassTimes, wait);
+	if (g_collectedGpuPassTimes.empty())
 	{
-		const CefRect& popupRect = cefMain->GetPopupRect();
-		glTexSubImage2D(GL_TEXTURE_2D, 0, popupRect.x, popupRect.y, popupRect.width, popupRect.height, GL_BGRA, GL_UNSIGNED_BYTE, popupBuffer);
+		return;
 	}
-	glGenerateMipmap(GL_TEXTURE_2D);
-	glUniform1i(g_uiTextureId, g_uiTextureUnit);
 
-	glDrawElements(GL_TRIANGLES, (GLsizei)uiIndices.size(), GL_UNSIGNED_INT, NULL);
+	if (g_headless && g_frameIndex > BENCHMARK_WARMUP_FRAMES)
+	{
+		g_benchmarkGpuPassTimes.insert(
+			g_benchmarkGpuPassTimes.end(),
+			g_collectedGpuPassTimes.begin(),
+			g_collectedGpuPassTimes.end());
+	}
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
+	std::lock_guard<std::mutex> lock(g_latestGpuPassTimesMutex);
+	g_latestGpuPassTimes = g_collectedGpuPassTimes.back();
+	g_hasLatestGpuPassTimes = true;
 }
 
-void Render()
+void Render(const CE::RenderPacket& packet)
 {
+	CE_REQUIRE_RENDER_THREAD();
+
+	++g_frameIndex;
+	g_streamingBuffer->BeginFrame();
+	g_uiUploadBuffer->BeginFrame();
+	if (g_skinnedVertexBuffer != nullptr)
+	{
+		g_skinnedVertexBuffer->BeginFrame();
+	}
+	CE::GLStateCache::Get().BeginFrame();
+
+	bool isTimedFrame = g_headless && g_frameIndex > BENCHMARK_WARMUP_FRAMES;
+	// The counters of a frame are only complete once the next one begins.
+	if (g_headless && g_frameIndex > BENCHMARK_WARMUP_FRAMES + 1)
+	{
+		const CE::GLStateCounters& glCalls = CE::GLStateCache::Get().GetFrameCounters();
+		g_benchmarkGlCallsIssued.push_back((float) glCalls.issued);
+		g_benchmarkGlCallsFiltered.push_back((float) glCalls.filtered);
+	}
+	uint64_t renderStartTicks = SDL_GetPerformanceCounter();
+	g_gpuPassTimer->BeginFrame();
+
+	// The clear counts towards the first pass.
+	g_gpuPassTimer->BeginPass(CE::GpuPass::UI_OPAQUE);
+
 	//Clear color buffer
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	// TODO: Is this required? Works without it?
-	glBindVertexArray(g_vao);
+	// The UI is in front of everything, so opaque UI goes first. Then,
+	// everything behind it fails the depth test. Opaque tiles need no blending.
+	UploadUITexture();
+	CE::GLStateCache::Get().Disable(GL_BLEND);
+	RenderUITiles(CE::UITile::FULLY_OPAQUE);
+	CE::GLStateCache::Get().Enable(GL_BLEND);
+	g_gpuPassTimer->EndPass();
 
-	glm::mat4 projection = glm::perspective(glm::quarter_pi<float>(), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 10000.0f);
-	glm::mat4 view = g_camera->CreateViewMatrix();
-	glm::mat4 model = glm::mat4(1.0f);
-	glm::mat4 projectionViewModel = projection * view * model;
+	g_gpuPassTimer->BeginPass(CE::GpuPass::MESHES);
 
-	for (size_t i = 0; i < g_assetNames.size(); ++i)
+	const glm::mat4& projectionViewModel = packet.projectionViewModel;
+
+	if (packet.renderMesh && packet.instancing)
+	{
+		RenderMeshesInstanced(packet);
+	}
+	else if (packet.renderMesh)
+	{
+		for (size_t i = 0; i < packet.characters.size(); ++i)
+		{
+			RenderMesh(packet, i);
+		}
+	}
+
+	g_gpuPassTimer->EndPass();
+
+	if (packet.renderSkeleton)
 	{
-		RenderMesh(*g_meshComponents[i], *g_animationComponents[i], projectionViewModel);
-		RenderSkeleton(*g_animationComponents[i], projectionViewModel);
+		for (size_t i = 0; i < packet.characters.size(); ++i)
+		{
+			const CE::CharacterRenderPacket& character = packet.characters[i];
+			const CE::MeshInstance& instance = packet.instances[i];
+			const CE::Skeleton& skeleton = *g_skeletons[character.assetIndex];
+			if (character.paletteJointCount == skeleton.joints.size())
+			{
+				RenderSkeleton(skeleton, packet.palettes.data() + instance.paletteOffset, instance.model);
+			}
+		}
 	}
 
+	// Every skeleton in one batch.
+	g_gpuPassTimer->BeginPass(CE::GpuPass::SKELETONS);
+	CE::GLStateCache::Get().UseProgram(g_debugDrawProgramId);
+	g_debugDraw->Flush(g_debugDrawProjectionViewModelMatrixId, projectionViewModel, *g_streamingBuffer);
+	g_gpuPassTimer->EndPass();
+
+	g_gpuPassTimer->BeginPass(CE::GpuPass::GRID);
 	RenderGrid(projectionViewModel);
+	g_gpuPassTimer->EndPass();
+
+	// Translucent UI has to be blended over the scene, so it goes last. Empty
+	// tiles are never drawn.
+	g_gpuPassTimer->BeginPass(CE::GpuPass::UI);
+	RenderUITiles(CE::UITile::TRANSLUCENT);
+	g_gpuPassTimer->EndPass();
+
+	g_streamingBuffer->EndFrame();
+	g_uiUploadBuffer->EndFrame();
+	if (g_skinnedVertexBuffer != nullptr)
+	{
+		g_skinnedVertexBuffer->EndFrame();
+	}
+	g_gpuPassTimer->EndFrame();
 
-	// Because of depth testing, and because the UI is currently rendered as
-	// one giant texture the size of the screen instead of just its visible parts,
-	// we must render the UI last. Otherwise, everything fails the depth test.
-	//
-	// Once we render only visible parts, we could render the UI first.
-	// Then, everything behind the UI will fail the depth test, but for good reason.
-	RenderUI();
+	if (isTimedFrame)
+	{
+		g_renderCpuMilliseconds.push_back(TicksToMilliseconds(SDL_GetPerformanceCounter() - renderStartTicks));
+	}
+
+	CollectGpuPassTimes(false);
 }
 
 std::string ReadFile(const char *file)
@@ -540,108 +1126,63 @@ std::string ReadFile(const char *file)
 	return buffer.str();
 }
 
-GLuint CreateShader(GLenum shaderType, const char* shaderFileName)
+unsigned AddProgram(CE::ProgramBatch& programBatch, const char* vertexShaderFileName, const char* fragmentShaderFileName)
 {
-	GLuint shader = glCreateShader(shaderType);
-
-	std::string shaderSource = ReadFile(shaderFileName);
-	const char* shaderSourceStr = shaderSource.c_str();
-	glShaderSource(shader, 1, &shaderSourceStr, NULL);
-
-	glCompileShader(shader);
-
-	PrintShaderLog(shader);
-
-	GLint isShaderCompiled = GL_FALSE;
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &isShaderCompiled);
-	if (isShaderCompiled != GL_TRUE)
-	{
-		printf("unable to compile shader %s\n", shaderFileName);
-		return -1;
-	}
-
-	return shader;
+	return programBatch.AddProgram(
+		vertexShaderFileName,
+		ReadFile(vertexShaderFileName),
+		fragmentShaderFileName,
+		ReadFile(fragmentShaderFileName));
 }
 
-GLuint CreateProgram(const char* vertexShaderFileName, const char* fragmentShaderFileName)
+std::string GetProgramBinaryCacheFileName()
 {
-	GLuint programId = glCreateProgram();
-
-	GLuint vertexShader = CreateShader(GL_VERTEX_SHADER, vertexShaderFileName);
-	if (vertexShader == -1)
-	{
-		return -1;
-	}
-	glAttachShader(programId, vertexShader);
-
-	GLuint fragmentShader = CreateShader(GL_FRAGMENT_SHADER, fragmentShaderFileName);
-	if (fragmentShader == -1)
+	// The working directory, or the bundle on Apple, may not be writable.
+	char* prefPath = SDL_GetPrefPath("CompositeEngine", "CompositeEngine");
+	if (prefPath == NULL)
 	{
-		return -1;
+		return PROGRAM_BINARY_CACHE_FILE_NAME;
 	}
-	glAttachShader(programId, fragmentShader);
 
-	glLinkProgram(programId);
-
-	PrintProgramLog(programId);
-
-	GLint programSuccess = GL_TRUE;
-	glGetProgramiv(programId, GL_LINK_STATUS, &programSuccess);
-	if (programSuccess != GL_TRUE)
-	{
-		printf(
-			"error linking program %d for shaders %s and %s\n",
-			programId,
-			vertexShaderFileName,
-			fragmentShaderFileName);
-		return -1;
-	}
-
-	return programId;
+	std::string fileName = std::string(prefPath) + PROGRAM_BINARY_CACHE_FILE_NAME;
+	SDL_free(prefPath);
+	return fileName;
 }
 
-
 bool InitializeOpenGL()
 {
-	g_skinnedMeshDiffuseTextureProgramId = CreateProgram("shaders/SkinnedMeshShader.vert", "shaders/DiffuseTextureShader.frag");
-	if (g_skinnedMeshDiffuseTextureProgramId == -1)
-	{
-		return false;
-	}
-	g_skinnedMeshDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_skinnedMeshDiffuseTextureProgramId, "projectionViewModel");
-	g_skinnedMeshDiffuseTexturePaletteId = glGetUniformLocation(g_skinnedMeshDiffuseTextureProgramId, "palette");
-	g_skinnedMeshDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_skinnedMeshDiffuseTextureProgramId, "diffuseTexture");
-
-	g_skeletonProgramId = CreateProgram("shaders/SkeletonShader.vert", "shaders/FragmentShader.frag");
-	if (g_skeletonProgramId == -1)
-	{
-		return false;
-	}
-	g_skeletonProjectionViewModelMatrixId = glGetUniformLocation(g_skeletonProgramId, "projectionViewModel");
-	g_skeletonPaletteId = glGetUniformLocation(g_skeletonProgramId, "palette");
-
-	g_uiProgramId = CreateProgram("shaders/UIShader.vert", "shaders/UIShader.frag");
-	if (g_uiProgramId == -1)
+	// Everything is submitted up front, and the driver compiles while the assets load.
+	CE::ProgramBatch programBatch(g_programBinaryCache);
+
+	const char* skinningVaryings[] = { "skinnedPosition", "skinnedTextureCoordinate" };
+	const char* skinningDefines[CE::SKINNING_INFLUENCE_RANGE_COUNT] = {
+		"#define JOINT_INFLUENCES 1\n",
+		"#define JOINT_INFLUENCES 2\n",
+		"#define JOINT_INFLUENCES 4\n"
+	};
+	std::string skinningShaderSource = ReadFile("shaders/SkinningShader.vert");
+	unsigned skinningPrograms[CE::SKINNING_INFLUENCE_RANGE_COUNT];
+	for (unsigned i = 0; i < CE::SKINNING_INFLUENCE_RANGE_COUNT; ++i)
 	{
-		return false;
+		skinningPrograms[i] = programBatch.AddTransformFeedbackProgram(
+			"shaders/SkinningShader.vert",
+			skinningShaderSource,
+			skinningDefines[i],
+			skinningVaryings,
+			2);
 	}
-	g_uiTextureId = glGetUniformLocation(g_uiProgramId, "uiTexture");
 
-	g_gridProgramId = CreateProgram("shaders/GridShader.vert", "shaders/GridShader.frag");
-	if (g_gridProgramId == -1)
-	{
-		return false;
-	}
-	g_gridProjectionViewModelMatrixId = glGetUniformLocation(g_gridProgramId, "projectionViewModel");
+	unsigned meshDiffuseTextureProgram = AddProgram(programBatch, "shaders/MeshShader.vert", "shaders/DiffuseTextureShader.frag");
+	unsigned debugDrawProgram = AddProgram(programBatch, "shaders/DebugDrawShader.vert", "shaders/FragmentShader.frag");
+	unsigned uiProgram = AddProgram(programBatch, "shaders/UIShader.vert", "shaders/UIShader.frag");
+	unsigned gridProgram = AddProgram(programBatch, "shaders/GridShader.vert", "shaders/GridShader.frag");
+	unsigned meshWireFrameDiffuseTextureProgram = AddProgram(programBatch, "shaders/MeshShader.vert", "shaders/WireFrameDiffuseTextureShader.frag");
+	unsigned gpuAnimationDiffuseTextureProgram = AddProgram(programBatch, "shaders/SkinnedMeshGpuAnimationShader.vert", "shaders/DiffuseTextureShader.frag");
+	unsigned gpuAnimationWireFrameDiffuseTextureProgram = AddProgram(programBatch, "shaders/SkinnedMeshGpuAnimationShader.vert", "shaders/WireFrameDiffuseTextureShader.frag");
+	unsigned instancedMeshDiffuseTextureProgram = AddProgram(programBatch, "shaders/SkinnedMeshInstancedShader.vert", "shaders/DiffuseTextureShader.frag");
+	unsigned instancedMeshWireFrameDiffuseTextureProgram = AddProgram(programBatch, "shaders/SkinnedMeshInstancedShader.vert", "shaders/WireFrameDiffuseTextureShader.frag");
 
-	g_skinnedMeshWireFrameDiffuseTextureProgramId = CreateProgram("shaders/SkinnedMeshShader.vert", "shaders/WireFrameDiffuseTextureShader.frag");
-	if (g_skinnedMeshWireFrameDiffuseTextureProgramId == -1)
-	{
-		return false;
-	}
-	g_skinnedMeshWireFrameDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_skinnedMeshWireFrameDiffuseTextureProgramId, "projectionViewModel");
-	g_skinnedMeshWireFrameDiffuseTexturePaletteId = glGetUniformLocation(g_skinnedMeshWireFrameDiffuseTextureProgramId, "palette");
-	g_skinnedMeshWireFrameDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_skinnedMeshWireFrameDiffuseTextureProgramId, "diffuseTexture");
+	programBatch.Submit();
 
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -661,38 +1202,119 @@ bool InitializeOpenGL()
 			*animations,
 			*textures);
 
+		g_skeletons.push_back(skeleton);
+		InitializeBindPoseJointSpheres(*skeleton);
 		g_meshComponents.push_back(new CE::MeshComponent(meshes, textures));
-		g_animationComponents.push_back(new CE::AnimationComponent(skeleton, animations, eventSystem));
+		g_animationTextures.push_back(new CE::AnimationTexture(*skeleton, *animations, ANIMATION_TEXTURE_SAMPLE_RATE));
+
+		// Each asset's crowd stands behind the previous one's.
+		for (unsigned row = 0; row < CROWD_ROWS; ++row)
+		{
+			for (unsigned column = 0; column < CROWD_COLUMNS; ++column)
+			{
+				glm::vec3 location(
+					((float) column - (CROWD_COLUMNS - 1) * 0.5f) * CROWD_SPACING,
+					0.f,
+					-(float) (i * CROWD_ROWS + row) * CROWD_SPACING);
+
+				g_characterAssetIndices.push_back(i);
+				g_characterModels.push_back(glm::translate(glm::mat4(1.f), location));
+				g_characterMeshLods.push_back(0);
+				// Only the first character talks to the UI.
+				EventSystem* animationEventSystem = g_animationComponents.empty() ? eventSystem : nullptr;
+				g_animationComponents.push_back(new CE::AnimationComponent(skeleton, animations, animationEventSystem));
+				g_skinnedMeshCaches.push_back(new CE::SkinnedMeshCache(g_meshComponents.back()));
+			}
+		}
 	}
 
 	glGenVertexArrays(1, &g_vao);
-	glBindVertexArray(g_vao);
-
-	// TODO: Why do I need to bind the buffer immediately after generating it?
-	glGenBuffers(1, &g_vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, g_vbo);
+	CE::GLStateCache::Get().BindVertexArray(g_vao);
 
-	glGenBuffers(1, &g_ibo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ibo);
+	g_streamingBuffer = new CE::StreamingBuffer(STREAMING_BUFFER_FRAME_SIZE);
+	g_debugDraw = new CE::DebugDraw();
 
+	// Diffuse textures are owned by CE::TextureCache, and bound per mesh.
 	g_diffuseTextureUnit = 0;
-	glActiveTexture(GL_TEXTURE0 + g_diffuseTextureUnit);
-	glGenTextures(1, &g_diffuseTextureID);
-	glBindTexture(GL_TEXTURE_2D, g_diffuseTextureID);
 
 	// TODO: How much of this do I need to do here, versus every call?
 	g_paletteTextureUnit = 1;
+	// Palettes are streamed; g_tbo only backs them when texture buffer ranges are unavailable.
 	glGenBuffers(1, &g_tbo);
-	glBindBuffer(GL_TEXTURE_BUFFER, g_tbo);
-	glActiveTexture(GL_TEXTURE0 + g_paletteTextureUnit);
+	CE::GLStateCache::Get().BindBuffer(GL_TEXTURE_BUFFER, g_tbo);
+	glBufferData(GL_TEXTURE_BUFFER, CE::MAX_PALETTE_JOINTS * sizeof(glm::mat4), NULL, GL_DYNAMIC_COPY);
 	glGenTextures(1, &g_paletteGenTex);
-	glBindTexture(GL_TEXTURE_BUFFER, g_paletteGenTex);
-	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, g_tbo);
+	CE::GLStateCache::Get().BindTexture(g_paletteTextureUnit, GL_TEXTURE_BUFFER, g_paletteGenTex);
+	CE::GLStateCache::Get().TexBufferRange(GL_RGBA32F, g_tbo, 0, 0);
+
+	if (!programBatch.Finish())
+	{
+		return false;
+	}
+
+	for (unsigned i = 0; i < CE::SKINNING_INFLUENCE_RANGE_COUNT; ++i)
+	{
+		g_skinningProgramIds[i] = programBatch.GetProgramId(skinningPrograms[i]);
+		g_skinningPaletteIds[i] = glGetUniformLocation(g_skinningProgramIds[i], "palette");
+	}
+
+	g_meshDiffuseTextureProgramId = programBatch.GetProgramId(meshDiffuseTextureProgram);
+	g_meshDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_meshDiffuseTextureProgramId, "projectionViewModel");
+	g_meshDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_meshDiffuseTextureProgramId, "diffuseTexture");
+
+	g_debugDrawProgramId = programBatch.GetProgramId(debugDrawProgram);
+	g_debugDrawProjectionViewModelMatrixId = glGetUniformLocation(g_debugDrawProgramId, "projectionViewModel");
 
+	g_uiProgramId = programBatch.GetProgramId(uiProgram);
+	g_uiTextureId = glGetUniformLocation(g_uiProgramId, "uiTexture");
+
+	g_gridProgramId = programBatch.GetProgramId(gridProgram);
+	g_gridProjectionViewModelMatrixId = glGetUniformLocation(g_gridProgramId, "projectionViewModel");
+
+	g_meshWireFrameDiffuseTextureProgramId = programBatch.GetProgramId(meshWireFrameDiffuseTextureProgram);
+	g_meshWireFrameDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_meshWireFrameDiffuseTextureProgramId, "projectionViewModel");
+	g_meshWireFrameDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_meshWireFrameDiffuseTextureProgramId, "diffuseTexture");
+
+	g_gpuAnimationDiffuseTextureProgramId = programBatch.GetProgramId(gpuAnimationDiffuseTextureProgram);
+	g_gpuAnimationDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_gpuAnimationDiffuseTextureProgramId, "projectionViewModel");
+	g_gpuAnimationDiffuseTextureAnimationTextureId = glGetUniformLocation(g_gpuAnimationDiffuseTextureProgramId, "animationTexture");
+	g_gpuAnimationDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_gpuAnimationDiffuseTextureProgramId, "diffuseTexture");
+
+	g_gpuAnimationWireFrameDiffuseTextureProgramId = programBatch.GetProgramId(gpuAnimationWireFrameDiffuseTextureProgram);
+	g_gpuAnimationWireFrameDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_gpuAnimationWireFrameDiffuseTextureProgramId, "projectionViewModel");
+	g_gpuAnimationWireFrameDiffuseTextureAnimationTextureId = glGetUniformLocation(g_gpuAnimationWireFrameDiffuseTextureProgramId, "animationTexture");
+	g_gpuAnimationWireFrameDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_gpuAnimationWireFrameDiffuseTextureProgramId, "diffuseTexture");
+
+	g_instancedMeshDiffuseTextureProgramId = programBatch.GetProgramId(instancedMeshDiffuseTextureProgram);
+	g_instancedMeshDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_instancedMeshDiffuseTextureProgramId, "projectionViewModel");
+	g_instancedMeshDiffuseTexturePaletteId = glGetUniformLocation(g_instancedMeshDiffuseTextureProgramId, "palette");
+	g_instancedMeshDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_instancedMeshDiffuseTextureProgramId, "diffuseTexture");
+
+	g_instancedMeshWireFrameDiffuseTextureProgramId = programBatch.GetProgramId(instancedMeshWireFrameDiffuseTextureProgram);
+	g_instancedMeshWireFrameDiffuseTextureProjectionViewModelMatrixId = glGetUniformLocation(g_instancedMeshWireFrameDiffuseTextureProgramId, "projectionViewModel");
+	g_instancedMeshWireFrameDiffuseTexturePaletteId = glGetUniformLocation(g_instancedMeshWireFrameDiffuseTextureProgramId, "palette");
+	g_instancedMeshWireFrameDiffuseTextureDiffuseTextureId = glGetUniformLocation(g_instancedMeshWireFrameDiffuseTextureProgramId, "diffuseTexture");
+
+	// Skinning switches between permutations mid-pass, so their samplers are set up front.
+	for (unsigned i = 0; i < CE::SKINNING_INFLUENCE_RANGE_COUNT; ++i)
+	{
+		CE::GLStateCache::Get().UseProgram(g_skinningProgramIds[i]);
+		CE::GLStateCache::Get().Uniform1i(g_skinningPaletteIds[i], g_paletteTextureUnit);
+	}
+
+	// The UI texture is mapped 1:1 to the screen, so it has no mipmaps. Its
+	// storage is allocated once; CEF's paints are uploaded into it.
 	g_uiTextureUnit = 2;
-	glActiveTexture(GL_TEXTURE0 + g_uiTextureUnit);
 	glGenTextures(1, &g_uiTextureID);
-	glBindTexture(GL_TEXTURE_2D, g_uiTextureID);
+	CE::GLStateCache::Get().BindTexture(g_uiTextureUnit, GL_TEXTURE_2D, g_uiTextureID);
+	CE::GLStateCache::Get().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	CE::GLStateCache::Get().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	CE::GLStateCache::Get().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	CE::GLStateCache::Get().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	CE::GLStateCache::Get().TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+	g_uiUploadBuffer = new CE::StreamingBuffer(UI_UPLOAD_BUFFER_FRAME_SIZE);
+	g_uiTileMap = new CE::UITileMap(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 	return true;
 }
@@ -716,7 +1338,164 @@ void WindowsMessageHook(
 }
 #endif
 
-bool Initialize(int argc, char* argv[])
+bool HasArgument(int argc, char* argv[], const char* argument)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], argument) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool IsSoftwareRenderer(const char* renderer)
+{
+	const char* softwareRenderers[] = { "llvmpipe", "softpipe", "SwiftShader", "Software Renderer" };
+	for (const char* softwareRenderer : softwareRenderers)
+	{
+		if (renderer != NULL && strstr(renderer, softwareRenderer) != NULL)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void InitializeSkinningBackend(int argc, char* argv[], const char* renderer)
+{
+	bool useCpu = HasArgument(argc, argv, "--cpu-skinning") || IsSoftwareRenderer(renderer);
+	if (HasArgument(argc, argv, "--gpu-skinning"))
+	{
+		useCpu = false;
+	}
+
+	if (!useCpu)
+	{
+		g_skinningBackend = SkinningBackend::TRANSFORM_FEEDBACK;
+		return;
+	}
+
+	// The main and render threads are busy with their own work.
+	unsigned hardwareThreads = std::thread::hardware_concurrency();
+	unsigned workerCount = hardwareThreads > 2 ? hardwareThreads - 2 : 0;
+
+	size_t skinnedVertexFrameSize = 0;
+	for (const CE::SkinnedMeshCache* skinnedMeshCache : g_skinnedMeshCaches)
+	{
+		skinnedVertexFrameSize += skinnedMeshCache->GetSkinnedVertexSize();
+	}
+
+	g_skinningBackend = SkinningBackend::CPU;
+	g_cpuSkinner = new CE::CpuSkinner(workerCount);
+	g_skinnedVertexBuffer = new CE::StreamingBuffer(skinnedVertexFrameSize);
+	printf("Skinning on the CPU with %u workers.\n", workerCount);
+}
+
+void ParseBenchmarkArguments(int argc, char* argv[])
+{
+	bool hasAssetArguments = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+		{
+			g_headless = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			g_benchmarkFrameCount = (unsigned) strtoul(argv[++i], NULL, 10);
+		}
+		else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+		{
+			g_benchmarkReportFileName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--asset") == 0 && i + 1 < argc)
+		{
+			// Any --asset replaces the default assets.
+			if (!hasAssetArguments)
+			{
+				g_assetNames.clear();
+				hasAssetArguments = true;
+			}
+			g_assetNames.push_back(argv[++i]);
+		}
+	}
+}
+
+void ParseUIArguments(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--ui-frame-rate") == 0 && i + 1 < argc)
+		{
+			g_uiFrameRateSettings.activeFrameRate = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--ui-idle-frame-rate") == 0 && i + 1 < argc)
+		{
+			g_uiFrameRateSettings.idleFrameRate = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--ui-idle-frames") == 0 && i + 1 < argc)
+		{
+			g_uiFrameRateSettings.idleFrameCount = (unsigned) strtoul(argv[++i], NULL, 10);
+		}
+	}
+}
+
+bool WriteBenchmarkReport(const std::vector<float>& cpuFrameMilliseconds)
+{
+	std::string assetNames;
+	for (const char* assetName : g_assetNames)
+	{
+		assetNames += assetNames.empty() ? "" : ";";
+		assetNames += assetName;
+	}
+
+	CE::FrameTimeReport report;
+	report.AddInfo("renderer", g_rendererName);
+	report.AddInfo("videoDriver", g_videoDriverName);
+	report.AddInfo("assets", assetNames);
+	report.AddInfo("skinning", g_skinningBackend == SkinningBackend::CPU ? "cpu" : "transformFeedback");
+	report.AddInfo("instancing", engine->IsInstancing() && g_skinningBackend != SkinningBackend::CPU ? "on" : "off");
+	report.AddInfo("timestepSeconds", BENCHMARK_TIMESTEP_SECONDS);
+	report.AddInfo("warmupFrames", (float) BENCHMARK_WARMUP_FRAMES);
+	report.AddSeries("cpuFrameMilliseconds", cpuFrameMilliseconds);
+	report.AddSeries("cpuRenderMilliseconds", g_renderCpuMilliseconds);
+	report.AddSeries("glStateCallsIssued", g_benchmarkGlCallsIssued);
+	report.AddSeries("glStateCallsFiltered", g_benchmarkGlCallsFiltered);
+
+	const char* gpuPassSeriesNames[CE::GPU_PASS_COUNT] = {
+		"gpuUiOpaqueMilliseconds",
+		"gpuMeshMilliseconds",
+		"gpuSkeletonMilliseconds",
+		"gpuGridMilliseconds",
+		"gpuUiTranslucentMilliseconds"
+	};
+	std::vector<float> gpuMilliseconds(g_benchmarkGpuPassTimes.size());
+	for (unsigned pass = 0; pass < CE::GPU_PASS_COUNT; ++pass)
+	{
+		for (size_t i = 0; i < g_benchmarkGpuPassTimes.size(); ++i)
+		{
+			gpuMilliseconds[i] = g_benchmarkGpuPassTimes[i].passMilliseconds[pass];
+		}
+		report.AddSeries(gpuPassSeriesNames[pass], gpuMilliseconds);
+	}
+	for (size_t i = 0; i < g_benchmarkGpuPassTimes.size(); ++i)
+	{
+		gpuMilliseconds[i] = g_benchmarkGpuPassTimes[i].totalMilliseconds;
+	}
+	report.AddSeries("gpuFrameMilliseconds", gpuMilliseconds);
+
+	if (!report.Write(g_benchmarkReportFileName))
+	{
+		return false;
+	}
+
+	printf("Wrote benchmark report %s\n", g_benchmarkReportFileName);
+	return true;
+}
+
+bool InitializeVideo()
 {
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0)
 	{
@@ -741,7 +1520,7 @@ bool Initialize(int argc, char* argv[])
 		SDL_WINDOWPOS_UNDEFINED,
 		SCREEN_WIDTH,
 		SCREEN_HEIGHT,
-		SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN);
+		SDL_WINDOW_OPENGL | (g_headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN));
 
 	if (g_window == NULL)
 	{
@@ -757,9 +1536,28 @@ bool Initialize(int argc, char* argv[])
 	if (g_context == NULL)
 	{
 		printf("OpenGL context could not be created! SDL_Error: %s\n", SDL_GetError());
+		SDL_DestroyWindow(g_window);
+		g_window = NULL;
 		return false;
 	}
 
+	return true;
+}
+
+bool Initialize(int argc, char* argv[])
+{
+	ParseBenchmarkArguments(argc, argv);
+	ParseUIArguments(argc, argv);
+
+	if (!InitializeVideo())
+	{
+		return false;
+	}
+
+	const char* videoDriver = SDL_GetCurrentVideoDriver();
+	g_videoDriverName = videoDriver != NULL ? videoDriver : "";
+	printf("SDL video driver: %s\n", g_videoDriverName.c_str());
+
 #ifdef _WIN32
 	SDL_SetWindowsMessageHook(&WindowsMessageHook, nullptr);
 #endif
@@ -788,13 +1586,23 @@ bool Initialize(int argc, char* argv[])
 	eventSystem = new EventSystem();
 	engine = new CE::Engine(eventSystem);
 	
-	cefMain = new CE::CefMain(eventSystem, g_window);
+	if (!g_headless)
+	{
+		cefMain = new CE::CefMain(eventSystem, g_window);
+	}
 
 	g_fpsCounter = new CE::FpsCounter(eventSystem);
+	g_gpuTimeCounter = new CE::GpuTimeCounter(eventSystem);
 
 	g_camera = new CE::Camera(glm::vec3(0, 100, 700), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
 
-	if (!InitializeOpenGL())
+	g_programBinaryCache = new CE::ProgramBinaryCache(GetProgramBinaryCacheFileName().c_str());
+	bool isOpenGLInitialized = InitializeOpenGL();
+	g_programBinaryCache->Save();
+	delete g_programBinaryCache;
+	g_programBinaryCache = nullptr;
+
+	if (!isOpenGLInitialized)
 	{
 		printf("Unable to initialize OpenGL!\n");
 		return false;
@@ -804,6 +1612,9 @@ bool Initialize(int argc, char* argv[])
 	const GLubyte* version = glGetString(GL_VERSION); // version as a string
 	printf("GL_RENDERER: %s\n", renderer);
 	printf("GL_VERSION: %s\n", version);
+	g_rendererName = renderer != NULL ? (const char*) renderer : "";
+
+	InitializeSkinningBackend(argc, argv, (const char*) renderer);
 	// TODO: Doesn't work on my laptop's Intel HD Graphics 4000, which only supports up to OpenGL 4.0.
 
 	// GLint components;
@@ -811,35 +1622,86 @@ bool Initialize(int argc, char* argv[])
 	// printf("GL_MAX_VERTEX_UNIFORM_COMPONENTS: %u\n", components);
 
 	// tell GL to only draw onto a pixel if the shape is closer to the viewer
-	glEnable(GL_DEPTH_TEST); // enable depth-testing
+	CE::GLStateCache::Get().Enable(GL_DEPTH_TEST); // enable depth-testing
 	glDepthFunc(GL_LESS); // depth-testing interprets a smaller value as "closer"
 
 	// Enable MSAA.
-	glEnable(GL_MULTISAMPLE);
+	CE::GLStateCache::Get().Enable(GL_MULTISAMPLE);
 
 	// enable alpha blending (allows transparent textures)
 	// https://gamedev.stackexchange.com/questions/29492/opengl-blending-gui-textures
 	// https://www.opengl.org/archives/resources/faq/technical/transparency.htm
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	CE::GLStateCache::Get().Enable(GL_BLEND);
+	CE::GLStateCache::Get().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	if (!cefMain->StartCef(argc, argv, SCREEN_WIDTH, SCREEN_HEIGHT))
+	if (cefMain != nullptr && !cefMain->StartCef(argc, argv, SCREEN_WIDTH, SCREEN_HEIGHT, g_uiFrameRateSettings))
 	{
 		printf("CEF failed to start!\n");
 		return false;
 	}
 
+	g_gpuPassTimer = new CE::GpuPassTimer(g_headless);
+
+	// From here on, only the render thread issues GL calls.
+	SDL_GL_MakeCurrent(g_window, NULL);
+	g_renderThread = new CE::RenderThread(g_window, g_context, &Render);
+	g_renderThread->Start();
+
 	return true;
 }
 
 void Destroy()
 {
+	// Lets the last submitted frame finish, and hands the context back.
+	g_renderThread->Stop();
+	delete g_renderThread;
+	g_renderThread = nullptr;
+	SDL_GL_MakeCurrent(g_window, g_context);
+
+	// Benchmarks keep the frames that were still in flight.
+	CollectGpuPassTimes(g_headless);
+	delete g_gpuPassTimer;
+	g_gpuPassTimer = nullptr;
+
 	CE::MeshManager::Get().Destroy();
 	CE::AnimationManager::Get().Destroy();
 	CE::SkeletonManager::Get().Destroy();
 	CE::TextureManager::Get().Destroy();
+	CE::TextureCache::Get().Destroy();
+
+	for (CE::AnimationTexture* animationTexture : g_animationTextures)
+	{
+		delete animationTexture;
+	}
+	g_animationTextures.clear();
+
+	for (CE::SkinnedMeshCache* skinnedMeshCache : g_skinnedMeshCaches)
+	{
+		delete skinnedMeshCache;
+	}
+	g_skinnedMeshCaches.clear();
+
+	delete g_debugDraw;
+	g_debugDraw = nullptr;
+
+	delete g_streamingBuffer;
+	g_streamingBuffer = nullptr;
+
+	delete g_uiUploadBuffer;
+	g_uiUploadBuffer = nullptr;
+	delete g_uiTileMap;
+	g_uiTileMap = nullptr;
+	CE::GLStateCache::Get().DeleteTextures(1, &g_uiTextureID);
 
-	cefMain->StopCef();
+	delete g_cpuSkinner;
+	g_cpuSkinner = nullptr;
+	delete g_skinnedVertexBuffer;
+	g_skinnedVertexBuffer = nullptr;
+
+	if (cefMain != nullptr)
+	{
+		cefMain->StopCef();
+	}
 
 	SDL_DestroyWindow(g_window);
 	g_window = NULL;
@@ -867,12 +1729,17 @@ int main(int argc, char* argv[])
 
 	CE::EditorCameraEventHandler editorCameraEventHandler(eventSystem, g_camera);
 
+	// Headless runs simulate the same frames however fast they render.
+	const uint64_t benchmarkDeltaTicks = (uint64_t) (SDL_GetPerformanceFrequency() * BENCHMARK_TIMESTEP_SECONDS);
+	unsigned frame = 0;
+	std::vector<float> cpuFrameMilliseconds;
+
 	while (!quit)
 	{
 		previousTicks = currentTicks;
 		currentTicks = SDL_GetPerformanceCounter();
 
-		uint64_t deltaTicks = currentTicks - previousTicks;
+		uint64_t deltaTicks = g_headless ? benchmarkDeltaTicks : currentTicks - previousTicks;
 		CE::RealTimeClock::Get().Update(deltaTicks);
 		CE::GameTimeClock::Get().Update(deltaTicks);
 
@@ -903,6 +1770,18 @@ int main(int argc, char* argv[])
 							break;
 						}
 
+						case SDLK_g:
+						{
+							eventSystem->EnqueueEvent(ToggleGpuAnimationEvent());
+							break;
+						}
+
+						case SDLK_i:
+						{
+							eventSystem->EnqueueEvent(ToggleInstancingEvent());
+							break;
+						}
+
 						case SDLK_e:
 						{
 							SetRenderModeEvent setRenderModeEvent;
@@ -919,21 +1798,57 @@ int main(int argc, char* argv[])
 
 		editorCameraEventHandler.Update(CE::RealTimeClock::Get().GetDeltaSeconds());
 
-		for (CE::AnimationComponent* animationComponent : g_animationComponents)
+		for (size_t i = 0; i < g_animationComponents.size(); ++i)
 		{
+			CE::AnimationComponent* animationComponent = g_animationComponents[i];
+			float cameraDistance = glm::distance(g_camera->GetLocation(), GetCharacterRootPosition(i));
+			unsigned lod = g_animationLodPolicy.SelectLod(cameraDistance);
+			animationComponent->SetLod(lod, g_animationLodPolicy.GetLevel(lod));
 			animationComponent->Update(CE::GameTimeClock::Get().GetDeltaSeconds());
 		}
 		g_fpsCounter->Update(CE::RealTimeClock::Get().GetDeltaSeconds());
+		if (cefMain != nullptr)
+		{
+			cefMain->Update(CE::RealTimeClock::Get().GetDeltaSeconds());
+		}
+
+		bool hasGpuPassTimes;
+		CE::GpuPassTimes gpuPassTimes;
+		{
+			std::lock_guard<std::mutex> lock(g_latestGpuPassTimesMutex);
+			hasGpuPassTimes = g_hasLatestGpuPassTimes;
+			gpuPassTimes = g_latestGpuPassTimes;
+			g_hasLatestGpuPassTimes = false;
+		}
+		if (hasGpuPassTimes)
+		{
+			g_gpuTimeCounter->Update(gpuPassTimes);
+		}
 
 		// TODO: Where does this go?
 		eventSystem->DispatchEvents(CE::RealTimeClock::Get().GetCurrentTicks());
 
-		Render();
+		// Waits only if the render thread is still drawing the frame before last.
+		BuildRenderPacket(g_renderThread->GetSimulationPacket());
+		g_renderThread->Submit();
 
-		SDL_GL_SwapWindow(g_window);
+		if (g_headless)
+		{
+			++frame;
+			if (frame > BENCHMARK_WARMUP_FRAMES)
+			{
+				cpuFrameMilliseconds.push_back(TicksToMilliseconds(SDL_GetPerformanceCounter() - currentTicks));
+			}
+			quit = frame >= BENCHMARK_WARMUP_FRAMES + g_benchmarkFrameCount;
+		}
 	}
 
 	Destroy();
 
+	if (g_headless && !WriteBenchmarkReport(cpuFrameMilliseconds))
+	{
+		return 1;
+	}
+
 	return 0;
 }
@@ -12,6 +12,7 @@
 #include "cef/client/UILifeSpanHandler.h"
 #include "cef/browser/UIQueryResponder.h"
 #include "cef/browser/UIExternalMessagePump.h"
+#include "cef/browser/UIFrameRateController.h"
 #include "include/wrapper/cef_message_router.h"
 #include "cef/browser/UIQueryHandler.h"
 
@@ -28,11 +29,30 @@
 
 namespace CE
 {
+	static bool IsSdlInputEvent(const SDL_Event& event)
+	{
+		switch (event.type)
+		{
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
+			case SDL_TEXTINPUT:
+			case SDL_MOUSEMOTION:
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+			case SDL_MOUSEWHEEL:
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
 	CefMain::CefMain(
             EventSystem* eventSystem,
             SDL_Window* window)
 		: eventSystem(eventSystem)
         , window(window)
+        , frameRateController(nullptr)
 	{
 		eventSystem->RegisterListener(this, EventType::SDL);
 		eventSystem->RegisterListener(this, EventType::WINDOWS_MESSAGE);
@@ -42,7 +62,8 @@ namespace CE
             int argc,
             char* argv[],
             uint32_t screenWidth,
-            uint32_t screenHeight)
+            uint32_t screenHeight,
+            const UIFrameRateSettings& frameRateSettings)
     {
 #ifdef __APPLE__
         CefScopedLibraryLoader libraryLoader;
@@ -60,8 +81,9 @@ namespace CE
 		mainArgs = CefMainArgs(argc, argv);
 #endif
 
-	    queryHandler = new UIQueryHandler(eventSystem, new UIQueryResponder(eventSystem));
         externalMessagePump = new UIExternalMessagePump();
+        frameRateController = new UIFrameRateController(frameRateSettings, externalMessagePump);
+	    queryHandler = new UIQueryHandler(eventSystem, new UIQueryResponder(eventSystem, frameRateController));
         CefRefPtr<UIBrowserProcessHandler> browserProcessHandler = new UIBrowserProcessHandler(externalMessagePump);
         CefRefPtr<UIAppBrowser> app = new UIAppBrowser(browserProcessHandler);
 
@@ -115,6 +137,7 @@ namespace CE
         }
 
         CefBrowserSettings browserSettings;
+        browserSettings.windowless_frame_rate = frameRateController->GetFrameRate();
         CefWindowInfo windowInfo;
 #ifdef _WIN32
         windowInfo.SetAsWindowless(sysInfo.info.win.window);
@@ -129,6 +152,7 @@ namespace CE
             "http://localhost:3000", // "about:blank"
             browserSettings,
             nullptr);
+        frameRateController->SetBrowser(browser);
         
         return true;
     }
@@ -139,25 +163,24 @@ namespace CE
 
         browser->GetHost()->CloseBrowser(true);
 
+        frameRateController->SetBrowser(nullptr);
         browser = nullptr;
         uiClient = nullptr;
 
         CefShutdown();
     }
 
-    const char* CefMain::GetViewBuffer()
+    void CefMain::Update(float deltaSeconds)
     {
-        return ((UIRenderHandler*)(uiClient->GetRenderHandler().get()))->GetViewBuffer();
-    }
-
-    const char* CefMain::GetPopupBuffer()
-    {
-        return ((UIRenderHandler*)(uiClient->GetRenderHandler().get()))->GetPopupBuffer();
+        if (frameRateController != nullptr)
+        {
+            frameRateController->Update(deltaSeconds);
+        }
     }
 
-    const CefRect& CefMain::GetPopupRect()
+    const UIFrame* CefMain::TakeLatestFrame()
     {
-        return ((UIRenderHandler*)(uiClient->GetRenderHandler().get()))->GetPopupRect();
+        return ((UIRenderHandler*)(uiClient->GetRenderHandler().get()))->TakeLatestFrame();
     }
 
 	void CefMain::OnEvent(const Event& event)
@@ -187,6 +210,11 @@ namespace CE
         
         externalMessagePump->ProcessEvent(nativeEvent);
 
+        if (IsSdlInputEvent(nativeEvent))
+        {
+            frameRateController->OnActivity();
+        }
+
         switch (nativeEvent.type)
         {
             case SDL_KEYDOWN:
@@ -566,6 +594,8 @@ namespace CE
 			case WM_KEYUP:
 			case WM_CHAR:
 			{
+				frameRateController->OnActivity();
+
 				CefKeyEvent keyEvent;
 				keyEvent.windows_key_code = static_cast<int>(windowsMessageEvent.wParam);
 				keyEvent.native_key_code = static_cast<int>(windowsMessageEvent.lParam);
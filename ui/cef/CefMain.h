@@ -11,6 +11,9 @@ class UIClient;
 class CefBrowser;
 class UIExternalMessagePump;
 class UIQueryHandler;
+class UIFrameRateController;
+struct UIFrame;
+struct UIFrameRateSettings;
 
 union SDL_Event;
 struct SDL_Window;
@@ -28,13 +31,16 @@ namespace CE
             int argc,
             char* argv[],
             uint32_t screenWidth,
-            uint32_t screenHeight);
+            uint32_t screenHeight,
+            const UIFrameRateSettings& frameRateSettings);
         void StopCef();
 
+        // Once per engine frame, on the main thread.
+        void Update(float deltaSeconds);
+
         // TODO: This probably shouldn't be architected this way.
-        const char* GetViewBuffer();
-        const char* GetPopupBuffer();
-        const CefRect& GetPopupRect();
+        // Only the renderer may call this. See UIRenderHandler.
+        const UIFrame* TakeLatestFrame();
 
 		// EventListener Interface
 		void OnEvent(const Event& event) override;
@@ -57,6 +63,7 @@ namespace CE
         CefRefPtr<CefBrowser> browser;
         UIExternalMessagePump* externalMessagePump;
         UIQueryHandler* queryHandler;
+        UIFrameRateController* frameRateController;
 	};
 }
 
@@ -12,8 +12,8 @@
 // OS X platform API compatibility.
 static const uint32_t TIMER_DELAY_PLACEHOLDER = (std::numeric_limits<uint32_t>::max)();
 
-// The maximum number of milliseconds we're willing to wait between calls to
-// DoWork().
+// The default maximum number of milliseconds we're willing to wait between
+// calls to DoWork().
 static const uint32_t TIMER_DELAY_MAX = 1000 / 30; // denominator = fps
 
 static const SDL_TimerID INVALID_TIMER_ID = 0;
@@ -23,6 +23,7 @@ static const uint32_t WORK_EVENT = SDL_RegisterEvents(1);
 
 UIExternalMessagePump::UIExternalMessagePump()
 	: timerId(INVALID_TIMER_ID)
+	, maxDelayMillis(TIMER_DELAY_MAX)
 	, active(false)
 	, reentrancyDetected(false)
 {
@@ -56,6 +57,11 @@ void UIExternalMessagePump::ProcessEvent(const SDL_Event& event)
 	}
 }
 
+void UIExternalMessagePump::SetMaxDelay(uint32_t delayMillis)
+{
+	maxDelayMillis = delayMillis > 0 ? delayMillis : 1;
+}
+
 void UIExternalMessagePump::Shutdown()
 {
 	KillTimer();
@@ -144,9 +150,9 @@ void UIExternalMessagePump::OnScheduleWork(uint32_t delayMillis)
 	else
 	{
 		// Never wait longer than the maximum allowed time.
-		if (delayMillis > TIMER_DELAY_MAX)
+		if (delayMillis > maxDelayMillis)
 		{
-			delayMillis = TIMER_DELAY_MAX;
+			delayMillis = maxDelayMillis;
 		}
 
 		// Results in call to OnTimerTimeout() after the specified delay.
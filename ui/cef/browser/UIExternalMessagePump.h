@@ -18,6 +18,9 @@ public:
 	void OnScheduleMessagePumpWork(uint32_t delayMillis);
 	void ProcessEvent(const SDL_Event& event);
 
+	// The longest to wait between calls to DoWork().
+	void SetMaxDelay(uint32_t delayMillis);
+
 	void Shutdown();
 
 private:
@@ -34,6 +37,7 @@ private:
 	bool PerformMessageLoopWork();
 
 	SDL_TimerID timerId;
+	uint32_t maxDelayMillis;
 	bool active;
 	bool reentrancyDetected;
 };
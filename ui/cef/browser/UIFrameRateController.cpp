@@ -0,0 +1,71 @@
+#include "UIFrameRateController.h"
+
+#include "UIExternalMessagePump.h"
+
+#include "common/debug/Assert.h"
+#include "common/debug/AssertThread.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// CEF clamps windowless frame rates to this range.
+static const int MIN_FRAME_RATE = 1;
+static const int MAX_FRAME_RATE = 60;
+
+UIFrameRateController::UIFrameRateController(const UIFrameRateSettings& settings, UIExternalMessagePump* externalMessagePump)
+	: settings(settings)
+	, externalMessagePump(externalMessagePump)
+	, frameRate(0)
+	, idleSeconds(0.f)
+{
+	this->settings.activeFrameRate = std::min(std::max(settings.activeFrameRate, MIN_FRAME_RATE), MAX_FRAME_RATE);
+	this->settings.idleFrameRate = std::min(std::max(settings.idleFrameRate, MIN_FRAME_RATE), this->settings.activeFrameRate);
+	SetFrameRate(this->settings.activeFrameRate);
+}
+
+void UIFrameRateController::SetBrowser(CefRefPtr<CefBrowser> browser)
+{
+	this->browser = browser;
+	if (browser.get() != nullptr)
+	{
+		browser->GetHost()->SetWindowlessFrameRate(frameRate);
+	}
+}
+
+void UIFrameRateController::OnActivity()
+{
+	CE_REQUIRE_MAIN_THREAD();
+
+	idleSeconds = 0.f;
+	SetFrameRate(settings.activeFrameRate);
+}
+
+void UIFrameRateController::Update(float deltaSeconds)
+{
+	CE_REQUIRE_MAIN_THREAD();
+
+	idleSeconds += deltaSeconds;
+	if (idleSeconds >= (float)settings.idleFrameCount / settings.activeFrameRate)
+	{
+		SetFrameRate(settings.idleFrameRate);
+	}
+}
+
+void UIFrameRateController::SetFrameRate(int frameRate)
+{
+	if (this->frameRate == frameRate)
+	{
+		return;
+	}
+
+	this->frameRate = frameRate;
+	printf("UI frame rate: %d\n", frameRate);
+
+	// Sleeping longer than a frame would only delay the frame.
+	externalMessagePump->SetMaxDelay(1000 / frameRate);
+
+	if (browser.get() != nullptr)
+	{
+		browser->GetHost()->SetWindowlessFrameRate(frameRate);
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef _CE_UI_FRAME_RATE_CONTROLLER_H_
+#define _CE_UI_FRAME_RATE_CONTROLLER_H_
+
+#include "include/cef_browser.h"
+
+class UIExternalMessagePump;
+
+struct UIFrameRateSettings
+{
+	// While the UI gets input, queries or state changes.
+	int activeFrameRate = 30;
+	// Once the UI has been idle for idleFrameCount frames at the active rate.
+	// The same as activeFrameRate to keep the rate fixed.
+	int idleFrameRate = 5;
+	unsigned idleFrameCount = 60;
+};
+
+// Lowers CEF's windowless frame rate, and how long the message pump may
+// sleep, while the UI is idle, so the renderer process stops producing
+// frames nobody needs. Any activity raises them again right away.
+//
+// Paints are not activity: most are the UI redrawing readouts the engine
+// pushes all the time, which would keep it from ever going idle. Anything
+// input starts, like a transition, plays out within the idle delay.
+class UIFrameRateController
+{
+public:
+	UIFrameRateController(const UIFrameRateSettings& settings, UIExternalMessagePump* externalMessagePump);
+
+	void SetBrowser(CefRefPtr<CefBrowser> browser);
+
+	// Input, or state sent to the UI.
+	void OnActivity();
+
+	void Update(float deltaSeconds);
+
+	int GetFrameRate() const { return frameRate; }
+
+private:
+	void SetFrameRate(int frameRate);
+
+	UIFrameRateSettings settings;
+	UIExternalMessagePump* externalMessagePump;
+	CefRefPtr<CefBrowser> browser;
+
+	int frameRate;
+	float idleSeconds;
+};
+
+#endif // _CE_UI_FRAME_RATE_CONTROLLER_H_
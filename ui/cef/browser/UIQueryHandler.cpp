@@ -11,6 +11,7 @@
 
 #include "common/json/JsonDeserializer.h"
 #include "event/FpsStateEvent.h"
+#include "event/GpuTimesStateEvent.h"
 
 UIQueryHandler::UIQueryHandler(
 		EventSystem* eventSystem,
@@ -82,6 +83,13 @@ bool UIQueryHandler::OnQuery(
 			return true;
 		}
 
+		case EventType::REQUEST_GPU_TIMES_STATE:
+		{
+			SendEvent<RequestGpuTimesStateEvent>(deserializer);
+			AddQueryToResponder(type, queryId, persistent, callback);
+			return true;
+		}
+
 		case EventType::TOGGLE_BIND_POSE:
 		{
 			SendEvent<SetRenderModeEvent>(deserializer);
@@ -1,13 +1,26 @@
 #include "UIQueryResponder.h"
 
+#include "UIFrameRateController.h"
+
 #include "event/core/EventSystem.h"
 
-UIQueryResponder::UIQueryResponder(EventSystem* eventSystem)
+// Readouts the engine pushes every update, whether or not anything changed.
+// The animation state advances every update while the animation plays.
+static bool IsPeriodicEvent(EventType type)
+{
+	return type == EventType::FPS_STATE
+		|| type == EventType::GPU_TIMES_STATE
+		|| type == EventType::ANIMATION_STATE;
+}
+
+UIQueryResponder::UIQueryResponder(EventSystem* eventSystem, UIFrameRateController* frameRateController)
+	: frameRateController(frameRateController)
 {
 	EventType types [] = {
 		EventType::PAUSE_STATE,
 		EventType::ANIMATION_STATE,
-		EventType::FPS_STATE
+		EventType::FPS_STATE,
+		EventType::GPU_TIMES_STATE
 	};
 
 	for (EventType type : types)
@@ -24,6 +37,8 @@ void UIQueryResponder::OnEvent(const Event& event)
 
 void UIQueryResponder::AddQuery(EventType type, const UIQuery& query)
 {
+	frameRateController->OnActivity();
+
 	switch (type)
 	{
 		case EventType::REQUEST_PAUSE_STATE:
@@ -43,6 +58,12 @@ void UIQueryResponder::AddQuery(EventType type, const UIQuery& query)
 			RegisterQueryForEvent(EventType::FPS_STATE, query);
 			break;
 		}
+
+		case EventType::REQUEST_GPU_TIMES_STATE:
+		{
+			RegisterQueryForEvent(EventType::GPU_TIMES_STATE, query);
+			break;
+		}
 	}
 }
 
@@ -82,6 +103,11 @@ void UIQueryResponder::BroadcastEvent(const Event& event)
 		return;
 	}
 
+	// The UI will likely repaint with the new state. Periodic readouts only
+	// count when they answer a request, or they would keep the UI from ever
+	// going idle; it picks them up at the idle frame rate instead.
+	bool isActivity = !IsPeriodicEvent(event.type);
+
 	std::string buffer = event.Serialize();
 
 	auto queriesIt = queries.begin();
@@ -96,6 +122,12 @@ void UIQueryResponder::BroadcastEvent(const Event& event)
 		else
 		{
 			queriesIt = queries.erase(queriesIt);
+			isActivity = true;
 		}
 	}
+
+	if (isActivity)
+	{
+		frameRateController->OnActivity();
+	}
 }
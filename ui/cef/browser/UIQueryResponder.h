@@ -8,11 +8,12 @@
 #include <unordered_map>
 
 class EventSystem;
+class UIFrameRateController;
 
 class UIQueryResponder : public EventListener
 {
 public:
-	UIQueryResponder(EventSystem* eventSystem);
+	UIQueryResponder(EventSystem* eventSystem, UIFrameRateController* frameRateController);
 
 	// EventListener Interface
 	void OnEvent(const Event& event) override;
@@ -24,6 +25,7 @@ private:
 	void RegisterQueryForEvent(EventType type, const UIQuery& query);
 	void BroadcastEvent(const Event& event);
 
+	UIFrameRateController* frameRateController;
 	std::unordered_map<EventType, std::list<UIQuery>> eventToQueries;
 };
 
@@ -0,0 +1,24 @@
+#ifndef _CE_UI_FRAME_H_
+#define _CE_UI_FRAME_H_
+
+#include "include/cef_base.h"
+
+#include <vector>
+
+// A painted frame of the UI, as handed from CEF to the renderer.
+struct UIFrame
+{
+	// BGRA with an upper-left origin, the size of the view.
+	std::vector<char> viewBuffer;
+	// Empty while no popup is shown.
+	std::vector<char> popupBuffer;
+	CefRect popupRect;
+
+	// Regions of the view that changed since the frame the renderer last
+	// took, in view coordinates. Covers at least what was painted since then.
+	std::vector<CefRect> dirtyRects;
+	// Whether the popup was painted, moved or painted over since then.
+	bool isPopupDirty;
+};
+
+#endif //_CE_UI_FRAME_H_
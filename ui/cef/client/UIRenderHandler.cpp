@@ -1,27 +1,105 @@
 #include "UIRenderHandler.h"
 
+#include <algorithm>
+#include <cstring>
+
+static bool Intersects(const CefRect& a, const CefRect& b)
+{
+	return a.x < b.x + b.width && b.x < a.x + a.width
+		&& a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static CefRect Clip(const CefRect& rect, int width, int height)
+{
+	int left = std::max(rect.x, 0);
+	int top = std::max(rect.y, 0);
+	int right = std::min(rect.x + rect.width, width);
+	int bottom = std::min(rect.y + rect.height, height);
+	if (right <= left || bottom <= top)
+	{
+		return CefRect(0, 0, 0, 0);
+	}
+	return CefRect(left, top, right - left, bottom - top);
+}
+
+// Merges rects that overlap, so a region painted over and over is only
+// copied and uploaded once.
+static void AddRect(std::vector<CefRect>& rects, const CefRect& rect)
+{
+	CefRect merged = rect;
+	for (size_t i = 0; i < rects.size();)
+	{
+		const CefRect& other = rects[i];
+		if (!Intersects(merged, other))
+		{
+			++i;
+			continue;
+		}
+
+		int right = std::max(merged.x + merged.width, other.x + other.width);
+		int bottom = std::max(merged.y + merged.height, other.y + other.height);
+		merged.x = std::min(merged.x, other.x);
+		merged.y = std::min(merged.y, other.y);
+		merged.width = right - merged.x;
+		merged.height = bottom - merged.y;
+
+		// The grown rect may now overlap rects already checked.
+		rects.erase(rects.begin() + i);
+		i = 0;
+	}
+	rects.push_back(merged);
+}
+
+static void CopyRect(char* destination, const char* source, unsigned destinationWidth, unsigned sourceWidth, const CefRect& rect)
+{
+	for (int y = rect.y; y < rect.y + rect.height; ++y)
+	{
+		memcpy(
+			destination + ((size_t)y * destinationWidth + rect.x) * 4,
+			source + ((size_t)y * sourceWidth + rect.x) * 4,
+			rect.width * 4);
+	}
+}
+
 UIRenderHandler::UIRenderHandler(unsigned width, unsigned height)
 	: width(width)
 	, height(height)
-	, viewBuffer(new char[width * height * 4])
-	, popupBuffer(nullptr)
+	, latestSlot(0 | FRESH_SLOT_BIT)
+	, readSlot(1)
+	, paintSlot(2)
+	, publishedSlot(0)
 	, popupRect(0, 0, 0, 0)
+	, unreadRects(1, CefRect(0, 0, width, height))
+	, isUnreadPopupDirty(false)
+	, isPublishPopupDirty(false)
 {
+	for (Slot& slot : slots)
+	{
+		slot.frame.viewBuffer.assign(width * height * 4, 0);
+		slot.frame.popupRect.Set(0, 0, 0, 0);
+		slot.frame.isPopupDirty = false;
+		slot.isPopupStale = false;
+	}
 
+	// The renderer's texture starts out undefined, so the first frame is all dirty.
+	slots[0].frame.dirtyRects = unreadRects;
 }
 
-void UIRenderHandler::Resize(unsigned width, unsigned height)
+void UIRenderHandler::Render()
 {
-	this->width = width;
-	this->height = height;
-
-	delete[] viewBuffer;
-	viewBuffer = new char[width * height * 4];
+	// TODO: Move code here from Main.cpp
 }
 
-void UIRenderHandler::Render()
+const UIFrame* UIRenderHandler::TakeLatestFrame()
 {
-	// TODO: Move code here from Main.cpp
+	if ((latestSlot.load(std::memory_order_relaxed) & FRESH_SLOT_BIT) == 0)
+	{
+		return nullptr;
+	}
+
+	// Only the renderer clears the bit, so the latest slot is still fresh.
+	readSlot = latestSlot.exchange(readSlot, std::memory_order_acq_rel) & ~FRESH_SLOT_BIT;
+	return &slots[readSlot].frame;
 }
 
 void UIRenderHandler::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect)
@@ -33,16 +111,24 @@ void UIRenderHandler::OnPopupShow(CefRefPtr<CefBrowser> browser, bool show)
 {
 	if (!show)
 	{
+		// The view underneath has to be uploaded again.
+		MarkDirty(Clip(popupRect, width, height), false);
 		popupRect.Set(0, 0, 0, 0);
-		delete[] popupBuffer;
-		popupBuffer = nullptr;
+		popupBuffer.clear();
+		MarkPopupDirty();
+		Publish();
 	}
 }
 
 void UIRenderHandler::OnPopupSize(CefRefPtr<CefBrowser> browser, const CefRect& rect)
 {
+	// The popup may have moved off part of the view.
+	MarkDirty(Clip(popupRect, width, height), false);
+
 	popupRect = rect;
-	popupBuffer = new char[popupRect.width * popupRect.height * 4];
+	popupBuffer.assign(popupRect.width * popupRect.height * 4, 0);
+	MarkPopupDirty();
+	Publish();
 }
 
 void UIRenderHandler::OnPaint(
@@ -57,14 +143,107 @@ void UIRenderHandler::OnPaint(
 	{
 		case PET_VIEW:
 		{
-			memcpy(this->viewBuffer, buffer, width * height * 4);
+			for (const CefRect& dirtyRect : dirtyRects)
+			{
+				MarkDirty(Clip(dirtyRect, std::min<int>(width, this->width), std::min<int>(height, this->height)), true);
+			}
+
+			// The buffer is the whole view, so it also covers what this slot
+			// missed while the others were painted.
+			Slot& slot = slots[paintSlot];
+			for (const CefRect& rect : slot.staleRects)
+			{
+				CopyRect(slot.frame.viewBuffer.data(), static_cast<const char*>(buffer), this->width, width, rect);
+			}
+			slot.staleRects.clear();
+			Publish();
 			break;
 		}
 
 		case PET_POPUP:
 		{
-			memcpy(this->popupBuffer, buffer, width * height * 4);
+			if (popupBuffer.size() == (size_t)width * height * 4)
+			{
+				memcpy(popupBuffer.data(), buffer, popupBuffer.size());
+				MarkPopupDirty();
+				Publish();
+			}
 			break;
 		}
 	}
 }
+
+void UIRenderHandler::MarkDirty(const CefRect& rect, bool isPainted)
+{
+	if (rect.IsEmpty())
+	{
+		return;
+	}
+
+	if (isPainted)
+	{
+		for (Slot& slot : slots)
+		{
+			AddRect(slot.staleRects, rect);
+		}
+	}
+
+	AddRect(unreadRects, rect);
+	AddRect(publishRects, rect);
+
+	// The popup is drawn over the view, so it is uploaded again after it.
+	if (!popupBuffer.empty() && Intersects(rect, popupRect))
+	{
+		isUnreadPopupDirty = true;
+		isPublishPopupDirty = true;
+	}
+}
+
+void UIRenderHandler::MarkPopupDirty()
+{
+	for (Slot& slot : slots)
+	{
+		slot.isPopupStale = true;
+	}
+
+	isUnreadPopupDirty = true;
+	isPublishPopupDirty = true;
+}
+
+void UIRenderHandler::Publish()
+{
+	Slot& slot = slots[paintSlot];
+
+	// The last published slot is up to date, and only ever read by the
+	// renderer, so it is safe to copy from.
+	const UIFrame& published = slots[publishedSlot].frame;
+	for (const CefRect& rect : slot.staleRects)
+	{
+		CopyRect(slot.frame.viewBuffer.data(), published.viewBuffer.data(), width, width, rect);
+	}
+	slot.staleRects.clear();
+
+	if (slot.isPopupStale)
+	{
+		slot.frame.popupBuffer = popupBuffer;
+		slot.frame.popupRect = popupRect;
+		slot.isPopupStale = false;
+	}
+
+	slot.frame.dirtyRects = unreadRects;
+	slot.frame.isPopupDirty = isUnreadPopupDirty;
+
+	publishedSlot = paintSlot;
+	unsigned previousSlot = latestSlot.exchange(paintSlot | FRESH_SLOT_BIT, std::memory_order_acq_rel);
+	paintSlot = previousSlot & ~FRESH_SLOT_BIT;
+
+	// Once the renderer has taken the previous frame, the next one only has
+	// to cover what changed since.
+	if ((previousSlot & FRESH_SLOT_BIT) == 0)
+	{
+		unreadRects.swap(publishRects);
+		isUnreadPopupDirty = isPublishPopupDirty;
+	}
+	publishRects.clear();
+	isPublishPopupDirty = false;
+}
@@ -1,16 +1,29 @@
 #ifndef _CE_UI_RENDER_HANDLER_H_
 #define _CE_UI_RENDER_HANDLER_H_
 
+#include "UIFrame.h"
+
 #include "include/cef_render_handler.h"
 
+#include <atomic>
+#include <vector>
+
+// Hands painted frames to the renderer through three slots: the one CEF
+// paints into, the one the renderer reads, and the latest painted one. Each
+// side swaps its slot with the latest one atomically, so neither blocks the
+// other, whichever thread CEF paints from.
 class UIRenderHandler : public CefRenderHandler
 {
 public:
 	UIRenderHandler(unsigned width, unsigned height);
 
-	void Resize(unsigned width, unsigned height);
 	void Render();
 
+	// Returns the latest frame if it is newer than the last one taken, and
+	// null otherwise. The frame stays valid until the next call. Only the
+	// renderer may call this.
+	const UIFrame* TakeLatestFrame();
+
 	// CefRenderHandler Interface
 	void GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) override;
 	void OnPopupShow(CefRefPtr<CefBrowser> browser, bool show) override;
@@ -23,21 +36,45 @@ public:
 		int width,
 		int height) override;
 
-	// TODO: Remove and render with Render().
-	char* GetViewBuffer() const { return viewBuffer; }
-	char* GetPopupBuffer() const { return popupBuffer; }
-	const CefRect& GetPopupRect() const { return popupRect; }
-
 private:
+	static const unsigned SLOT_COUNT = 3;
+	// Set on the latest slot until the renderer takes it.
+	static const unsigned FRESH_SLOT_BIT = 0x4;
+
+	struct Slot
+	{
+		UIFrame frame;
+		// Regions of the view painted since this slot was last painted.
+		std::vector<CefRect> staleRects;
+		bool isPopupStale;
+	};
+
+	// With isPainted, the rect changed in the view buffer. Otherwise, only
+	// the renderer has to upload it again, like when the popup moves off it.
+	void MarkDirty(const CefRect& rect, bool isPainted);
+	void MarkPopupDirty();
+	// Brings the painted slot up to date and makes it the latest.
+	void Publish();
+
 	unsigned width, height;
 
-	// From the CefRenderHandler OnPaint documentation:
-	// |buffer| will be |width|*|height|*4 bytes in size and
-	// represents a BGRA image with an upper-left origin.
-	char* viewBuffer;
-	char* popupBuffer;
+	Slot slots[SLOT_COUNT];
+	std::atomic<unsigned> latestSlot;
+
+	// Only touched by the renderer.
+	unsigned readSlot;
 
+	// Only touched by CEF's paint thread.
+	unsigned paintSlot;
+	unsigned publishedSlot;
+	std::vector<char> popupBuffer;
 	CefRect popupRect;
+	// Dirty since the last frame the renderer is known to have taken, and
+	// since the last publish.
+	std::vector<CefRect> unreadRects;
+	bool isUnreadPopupDirty;
+	std::vector<CefRect> publishRects;
+	bool isPublishPopupDirty;
 
 	// IMPLEMENT_* macros set access modifiers, so they must come last.
 	IMPLEMENT_REFCOUNTING(UIRenderHandler);
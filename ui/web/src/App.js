@@ -9,6 +9,7 @@ import './components/Toast/Toast.less';
 import Toolbar from './components/Toolbar/Toolbar';
 import AnimationControls from './containers/AnimationControls';
 import FpsCounter from './containers/FpsCounter';
+import GpuTimes from './containers/GpuTimes';
 import theme from './theme';
 
 const debugLayout = false;
@@ -25,6 +26,7 @@ class App extends Component {
           </Toolbar>
           <ToastContainer toastClassName="Toast" />
           <FpsCounter />
+          <GpuTimes />
         </>
       </ThemeProvider>
     );
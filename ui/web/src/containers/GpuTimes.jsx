@@ -0,0 +1,51 @@
+import React from 'react';
+import styled from 'styled-components';
+import Portal from '../components/Portal/Portal';
+import withGpuTimes from './withGpuTimes';
+
+const Container = styled.div`
+  position: absolute;
+  bottom: 40px;
+  right: 10px;
+  color: white;
+  padding: 3px 6px;
+  border-radius: 4px;
+  border: solid 1px rgba(255, 255, 255, 0.5);
+  background-color: rgba(0, 0, 0, 0.5);
+  font-variant-numeric: tabular-nums;
+`;
+
+const Row = styled.div`
+  display: flex;
+  justify-content: space-between;
+`;
+
+const Label = styled.span`
+  margin-right: 12px;
+`;
+
+const formatMilliseconds = (milliseconds) => `${milliseconds.toFixed(2)} ms`;
+
+const GpuTimes = withGpuTimes(({ gpuTimes }) => {
+  const passes = [
+    ['Meshes', gpuTimes.meshMilliseconds],
+    ['Skeletons', gpuTimes.skeletonMilliseconds],
+    ['Grid', gpuTimes.gridMilliseconds],
+    ['UI', gpuTimes.uiMilliseconds],
+    ['GPU total', gpuTimes.totalMilliseconds]
+  ];
+  return (
+    <Portal>
+      <Container>
+        {passes.map(([label, milliseconds]) => (
+          <Row key={label}>
+            <Label>{label}</Label>
+            <span>{formatMilliseconds(milliseconds)}</span>
+          </Row>
+        ))}
+      </Container>
+    </Portal>
+  );
+});
+
+export default GpuTimes;
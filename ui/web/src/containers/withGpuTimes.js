@@ -0,0 +1,21 @@
+import { connect } from 'react-redux';
+import { compose } from 'recompose';
+
+const mapStateToProps = (state) => {
+  return {
+    gpuTimes: state.animationState.gpuTimes
+  }
+};
+
+const mapDispatchToProps = (dispatch) => {
+  return {};
+};
+
+export default (Component) => {
+  return compose(
+    connect(
+      mapStateToProps,
+      mapDispatchToProps
+    )
+  )(Component);
+};
@@ -13,7 +13,8 @@ import { MessageTypes, subscribeToMessage } from './ipc';
 const {
   pauseStateUpdate,
   animationStateUpdate,
-  fpsCounterStateUpdate
+  fpsCounterStateUpdate,
+  gpuTimesStateUpdate
 } = Creators;
 
 // create the saga middleware
@@ -38,6 +39,10 @@ subscribeToMessage(MessageTypes.REQUEST_FPS_STATE, (state) => {
   store.dispatch(fpsCounterStateUpdate(state));
 });
 
+subscribeToMessage(MessageTypes.REQUEST_GPU_TIMES_STATE, (state) => {
+  store.dispatch(gpuTimesStateUpdate(state));
+});
+
 ReactDOM.render(
   <ReduxProvider store={store}>
     <App />
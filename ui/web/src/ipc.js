@@ -7,7 +7,9 @@ export const MessageTypes = Object.freeze({
   PAUSE_STATE: 5,
   SET_RENDER_MODE: 6,
   REQUEST_FPS_STATE: 7,
-  FPS_STATE: 8
+  FPS_STATE: 8,
+  REQUEST_GPU_TIMES_STATE: 14,
+  GPU_TIMES_STATE: 15
 });
 
 export const sendMessage = (action) => {
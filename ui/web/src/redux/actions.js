@@ -25,6 +25,7 @@ export const { Types, Creators } = createActions({
   pauseStateUpdate: ['payload'],
   animationStateUpdate: ['payload'],
   fpsCounterStateUpdate: ['payload'],
+  gpuTimesStateUpdate: ['payload'],
   setRenderMode,
   setAnimationTime
 });
@@ -5,7 +5,14 @@ const INITIAL_STATE = {
   isPlaying: true,
   currentTime: 0,
   duration: 0,
-  fps: 0
+  fps: 0,
+  gpuTimes: {
+    meshMilliseconds: 0,
+    skeletonMilliseconds: 0,
+    gridMilliseconds: 0,
+    uiMilliseconds: 0,
+    totalMilliseconds: 0
+  }
 };
 
 const HANDLERS = {
@@ -32,6 +39,19 @@ const HANDLERS = {
     };
   },
 
+  [Types.GPU_TIMES_STATE_UPDATE]: (state, action) => {
+    return {
+      ...state,
+      gpuTimes: {
+        meshMilliseconds: action.payload.meshMilliseconds,
+        skeletonMilliseconds: action.payload.skeletonMilliseconds,
+        gridMilliseconds: action.payload.gridMilliseconds,
+        uiMilliseconds: action.payload.uiMilliseconds,
+        totalMilliseconds: action.payload.totalMilliseconds
+      }
+    };
+  },
+
   [Types.SET_RENDER_MODE]: (state, action) => {
     return {
       ...state,